@@ -12189,7 +12189,12 @@ UNUSED static const Lights1 segment2_lights_unused = gdSPDefLights1(
 
 // 0x02014470 - 0x020144B0
 static const Mtx matrix_identity = {
-#ifndef GBI_FLOATS
+#if defined(GBI_NATIVE_MTX)
+    {{0x00010000, 0x00000000, 0x00000000, 0x00000000},
+     {0x00000000, 0x00010000, 0x00000000, 0x00000000},
+     {0x00000000, 0x00000000, 0x00010000, 0x00000000},
+     {0x00000000, 0x00000000, 0x00000000, 0x00010000}}
+#elif !defined(GBI_FLOATS)
     {{0x00010000, 0x00000000,
       0x00000001, 0x00000000},
      {0x00000000, 0x00010000,
@@ -12209,7 +12214,12 @@ static const Mtx matrix_identity = {
 
 // 0x020144B0 - 0x020144F0
 static const Mtx matrix_fullscreen = {
-#ifndef GBI_FLOATS
+#if defined(GBI_NATIVE_MTX)
+    {{65536 * 2 / SCREEN_WIDTH, 0x00000000, 0x00000000, 0x00000000},
+     {0x00000000, 65536 * 2 / SCREEN_HEIGHT, 0x00000000, 0x00000000},
+     {0x00000000, 0x00000000, -0x00010000, 0x00000000},
+     {-0x00010000, -0x00010000, -0x00010000, 0x00010000}}
+#elif !defined(GBI_FLOATS)
     {{0x00000000, 0x00000000,
       0x00000000, 0x00000000},
      {0x00000000, 0xffff0000,
@@ -94,6 +94,15 @@
 # define GBI_FLOATS
 #endif
 
+/*
+ * The DS port keeps fixed point matrices as plain s15.16 words in row-major
+ * order, so the renderer can give them to the matrix engine without unpacking
+ * (the host build uses the same layout, so it benchmarks the same conversions)
+ */
+#if (defined(TARGET_NDS) || defined(TARGET_HOST)) && !defined(GBI_FLOATS)
+# define GBI_NATIVE_MTX
+#endif
+
 #ifdef    F3DEX_GBI_2
 # ifndef  F3DEX_GBI
 #  define F3DEX_GBI
@@ -1182,6 +1191,7 @@ typedef struct {
  * 4x4 matrix, fixed point s15.16 format.
  * First 8 words are integer portion of the 4x4 matrix
  * Last 8 words are the fraction portion of the 4x4 matrix
+ * (With GBI_NATIVE_MTX, each word is instead one whole s15.16 element)
  */
 typedef s32	Mtx_t[4][4];
 
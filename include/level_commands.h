@@ -139,14 +139,15 @@
     CMD_PTR(NULL), \
     CMD_PTR(NULL)
 
+// Segments are named instead, so the ones that aren't linked in can be streamed from NitroFS
 #define LOAD_RAW(seg, romStart, romEnd) \
-    CMD_BBH(0x17, 0x0C, 0x0000), \
-    CMD_PTR(NULL), \
+    CMD_BBH(0x17, 0x0C, seg), \
+    CMD_PTR(#romStart), \
     CMD_PTR(NULL)
 
 #define LOAD_MIO0(seg, romStart, romEnd) \
-    CMD_BBH(0x18, 0x0C, 0x0000), \
-    CMD_PTR(NULL), \
+    CMD_BBH(0x18, 0x0C, seg), \
+    CMD_PTR(#romStart), \
     CMD_PTR(NULL)
 #else
 #define FIXED_LOAD(loadAddr, romStart, romEnd) \
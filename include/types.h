@@ -183,7 +183,11 @@ struct Object {
     } ptrData;
 #endif
     /*0x1C8*/ u32 unused1;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    /*0x1CC*/ const struct BhvCommand *curBhvCommand;
+#else
     /*0x1CC*/ const BehaviorScript *curBhvCommand;
+#endif
     /*0x1D0*/ u32 bhvStackIndex;
     /*0x1D4*/ uintptr_t bhvStack[8];
     /*0x1F4*/ s16 bhvDelayTimer;
@@ -235,6 +239,15 @@ struct Surface {
     } normal;
     /*0x28*/ f32 originOffset;
     /*0x2C*/ struct Object *object;
+#ifdef FIXED_POINT_COLLISION
+    // The same plane in 2.30 fixed point, used by the integer collision queries
+    /*0x30*/ struct {
+        s32 x;
+        s32 y;
+        s32 z;
+    } normalFixed;
+    /*0x40*/ s64 originOffsetFixed;
+#endif
 };
 
 struct MarioBodyState {
@@ -5,7 +5,25 @@
 
 #if !defined(VERSION_CN) || !defined(TARGET_N64)
 
-#ifndef GBI_FLOATS
+#if defined(GBI_NATIVE_MTX)
+void guMtxF2L(float mf[4][4], Mtx *m) {
+    int r, c;
+    for (r = 0; r < 4; r++) {
+        for (c = 0; c < 4; c++) {
+            m->m[r][c] = mf[r][c] * 65536.0f;
+        }
+    }
+}
+
+void guMtxL2F(float mf[4][4], Mtx *m) {
+    int r, c;
+    for (r = 0; r < 4; r++) {
+        for (c = 0; c < 4; c++) {
+            mf[r][c] = m->m[r][c] / 65536.0f;
+        }
+    }
+}
+#elif !defined(GBI_FLOATS)
 void guMtxF2L(float mf[4][4], Mtx *m) {
     int r, c;
     s32 tmp1;
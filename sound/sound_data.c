@@ -1,3 +1,7 @@
+// Banks are patched where they are on the DS, so their pointers need the data word aligned
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+__attribute__((aligned(16)))
+#endif
 unsigned char gSoundDataADSR[] = {
 #include "sound/sound_data.ctl.inc.c"
 };
@@ -49,35 +49,43 @@ struct AudioSessionSettingsEU gAudioSessionPresets[] = {
 // - memory used for temporary sequences
 // - memory used for temporary banks
 #if defined(VERSION_JP) || defined(VERSION_US)
+// Sequences and banks are used in place on the DS, so no session memory is set aside for them
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+#define SESSION_MEM(persistentSeq, persistentBank, temporarySeq, temporaryBank) 0, 0, 0, 0
+#else
+#define SESSION_MEM(persistentSeq, persistentBank, temporarySeq, temporaryBank) \
+    persistentSeq, persistentBank, temporarySeq, temporaryBank
+#endif
+
 struct AudioSessionSettings gAudioSessionPresets[18] = {
 #ifdef VERSION_JP
-    { 32000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, 0x3900, 0x6000, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, 0x3900, 0x6000, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, 0x3900, 0x6000, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0E00, 0x3FFF, 0x7FFF, 0x3900, 0x6000, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, 0x3900, 0x6000, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, 0x3E00, 0x6200, 0x3F00, 0x2A00 },
-    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, 0x3F00, 0x6200, 0x4400, 0x2A80 },
-    { 32000, 20, 1, 0x0800, 0x37FF, 0x7FFF, 0x3300, 0x5500, 0x4000, 0x1B00 },
+    { 32000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x3900, 0x6000, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, SESSION_MEM(0x3900, 0x6000, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, SESSION_MEM(0x3900, 0x6000, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0E00, 0x3FFF, 0x7FFF, SESSION_MEM(0x3900, 0x6000, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, SESSION_MEM(0x3900, 0x6000, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x3E00, 0x6200, 0x3F00, 0x2A00) },
+    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, SESSION_MEM(0x3F00, 0x6200, 0x4400, 0x2A80) },
+    { 32000, 20, 1, 0x0800, 0x37FF, 0x7FFF, SESSION_MEM(0x3300, 0x5500, 0x4000, 0x1B00) },
 #else
-    { 32000, 16, 1, 0x0C00, 0x2FFF, 0x7FFF, 0x3A00, 0x6D00, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, 0x3A00, 0x6D00, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, 0x3A00, 0x6D00, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0E00, 0x3FFF, 0x7FFF, 0x3A00, 0x6D00, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, 0x3A00, 0x6D00, 0x4400, 0x2A00 },
-    { 32000, 16, 1, 0x0C00, 0x2FFF, 0x7FFF, 0x4000, 0x6E00, 0x3F00, 0x2A00 },
-    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, 0x4100, 0x6E00, 0x4400, 0x2A80 },
-    { 32000, 20, 1, 0x0800, 0x37FF, 0x7FFF, 0x34C0, 0x6280, 0x4000, 0x1B00 },
+    { 32000, 16, 1, 0x0C00, 0x2FFF, 0x7FFF, SESSION_MEM(0x3A00, 0x6D00, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, SESSION_MEM(0x3A00, 0x6D00, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, SESSION_MEM(0x3A00, 0x6D00, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0E00, 0x3FFF, 0x7FFF, SESSION_MEM(0x3A00, 0x6D00, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, SESSION_MEM(0x3A00, 0x6D00, 0x4400, 0x2A00) },
+    { 32000, 16, 1, 0x0C00, 0x2FFF, 0x7FFF, SESSION_MEM(0x4000, 0x6E00, 0x3F00, 0x2A00) },
+    { 32000, 16, 1, 0x0A00, 0x47FF, 0x7FFF, SESSION_MEM(0x4100, 0x6E00, 0x4400, 0x2A80) },
+    { 32000, 20, 1, 0x0800, 0x37FF, 0x7FFF, SESSION_MEM(0x34C0, 0x6280, 0x4000, 0x1B00) },
 #endif
-    { 27000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 27000, 16, 1, 0x0800, 0x3FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 27000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 27000, 16, 1, 0x1000, 0x3FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 27000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 32000, 14, 1, 0x0800, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 32000, 12, 1, 0x0800, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 32000, 10, 1, 0x0800, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
-    { 32000, 8, 1, 0x0800, 0x2FFF, 0x7FFF, 0x2500, 0x5500, 0x7400, 0x2400 },
+    { 27000, 16, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 27000, 16, 1, 0x0800, 0x3FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 27000, 16, 1, 0x1000, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 27000, 16, 1, 0x1000, 0x3FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 27000, 16, 1, 0x0C00, 0x4FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 32000, 14, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 32000, 12, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 32000, 10, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
+    { 32000, 8, 1, 0x0800, 0x2FFF, 0x7FFF, SESSION_MEM(0x2500, 0x5500, 0x7400, 0x2400) },
     { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
 };
 #endif
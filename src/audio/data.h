@@ -138,6 +138,11 @@ extern OSMesgQueue *D_SH_80350FA8;
 #define UNUSED_COUNT_80333EE8 24
 #define AUDIO_HEAP_SIZE 0x2c500
 #define AUDIO_INIT_POOL_SIZE 0x2c00
+#elif defined(TARGET_NDS) || defined(TARGET_HOST)
+// Only notes, command buffers, and reverb come out of the heap, since sound data is used in place
+#define UNUSED_COUNT_80333EE8 16
+#define AUDIO_HEAP_SIZE 0x12000
+#define AUDIO_INIT_POOL_SIZE 0x2500
 #else
 #define UNUSED_COUNT_80333EE8 16
 #define AUDIO_HEAP_SIZE 0x31150
@@ -838,6 +838,16 @@ void *get_bank_or_seq_inner(s32 poolIdx, s32 arg1, s32 bankId) {
 }
 #endif
 #if !defined(VERSION_SH) && !defined(VERSION_CN)
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Banks and sequences are used in place rather than loaded into these pools, so one is available for as long
+// as its load status says it's loaded
+void *get_bank_or_seq(struct SoundMultiPool *arg0, UNUSED s32 arg1, s32 id) {
+    if (arg0 == &gBankLoadedPool) {
+        return IS_BANK_LOAD_COMPLETE(id) ? gAlCtlHeader->seqArray[id].offset + 0x10 : NULL;
+    }
+    return IS_SEQ_LOAD_COMPLETE(id) ? gSeqFileHeader->seqArray[id].offset : NULL;
+}
+#else
 void *get_bank_or_seq(struct SoundMultiPool *arg0, s32 arg1, s32 id) {
     u32 i;
     UNUSED void *ret;
@@ -877,6 +887,7 @@ void *get_bank_or_seq(struct SoundMultiPool *arg0, s32 arg1, s32 id) {
     }
 }
 #endif
+#endif
 
 #if defined(VERSION_EU) || defined(VERSION_SH) || defined(VERSION_CN)
 void func_eu_802e27e4_unused(f32 arg0, f32 arg1, u16 *arg2) {
@@ -1314,10 +1325,6 @@ void audio_reset_session(void) {
 #endif
 
     gNotes = soundAlloc(&gNotesAndBuffersPool, gMaxSimultaneousNotes * sizeof(struct Note));
-#ifdef TARGET_NDS
-    // Point to the uncached RAM mirror so both CPUs can access the data reliably
-    gNotes = (struct Note*)((u32)gNotes + 0xA000000);
-#endif
     note_init_all();
     init_note_free_list();
 
@@ -198,6 +198,17 @@ void decrease_sample_dma_ttls() {
     sUnused80226B40 = 0;
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Samples are read straight from the linked sound data, so there are no DMA buffers to cache them in
+void *dma_sample_data(uintptr_t devAddr, UNUSED u32 size, UNUSED s32 arg2, UNUSED u8 *dmaIndexRef) {
+    return (void *) devAddr;
+}
+
+void init_sample_dma_buffers(UNUSED s32 arg0) {
+    gSampleDmaNumListItems = 0;
+    sSampleDmaListSize1 = 0;
+}
+#else
 void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
     s32 hasDma = FALSE;
     struct SharedDma *dma;
@@ -406,6 +417,7 @@ out2:
 #undef j
 #endif
 }
+#endif
 
 #if defined(VERSION_JP) || defined(VERSION_US)
 // This function gets optimized out on US due to being static and never called
@@ -579,6 +591,41 @@ l2:
 #undef PATCH_SOUND
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// All sound data is linked into RAM on the DS, so banks and sequences are used where they are instead of
+// being copied into the audio heap. get_bank_or_seq finds them through the load status.
+struct AudioBank *bank_load_immediate(s32 bankId, UNUSED s32 arg1) {
+    u8 *ctlData = gAlCtlHeader->seqArray[bankId].offset;
+    u32 numInstruments = ((u32 *) ctlData)[0];
+    u32 numDrums = ((u32 *) ctlData)[1];
+    struct AudioBank *ret = (struct AudioBank *) (ctlData + 0x10);
+
+    // A bank's pointers are patched in place the first time it loads, and stay patched across session resets
+    if (gCtlEntries[bankId].instruments == NULL) {
+        patch_audio_bank(ret, gAlTbl->seqArray[bankId].offset, numInstruments, numDrums);
+        osWritebackDCache(ret, gAlCtlHeader->seqArray[bankId].len);
+        gCtlEntries[bankId].numInstruments = (u8) numInstruments;
+        gCtlEntries[bankId].numDrums = (u8) numDrums;
+        gCtlEntries[bankId].instruments = ret->instruments;
+        gCtlEntries[bankId].drums = ret->drums;
+    }
+    gBankLoadStatus[bankId] = SOUND_LOAD_STATUS_COMPLETE;
+    return ret;
+}
+
+struct AudioBank *bank_load_async(s32 bankId, s32 arg1, UNUSED struct SequencePlayer *seqPlayer) {
+    return bank_load_immediate(bankId, arg1);
+}
+
+void *sequence_dma_immediate(s32 seqId, UNUSED s32 arg1) {
+    gSeqLoadStatus[seqId] = SOUND_LOAD_STATUS_COMPLETE;
+    return gSeqFileHeader->seqArray[seqId].offset;
+}
+
+void *sequence_dma_async(s32 seqId, s32 arg1, UNUSED struct SequencePlayer *seqPlayer) {
+    return sequence_dma_immediate(seqId, arg1);
+}
+#else
 struct AudioBank *bank_load_immediate(s32 bankId, s32 arg1) {
     UNUSED u32 pad1[4];
     u32 buf[4];
@@ -721,6 +768,7 @@ void *sequence_dma_async(s32 seqId, s32 arg1, struct SequencePlayer *seqPlayer)
     }
     return ptr;
 }
+#endif
 
 u8 get_missing_bank(u32 seqId, s32 *nonNullCount, s32 *nullCount) {
     void *temp;
@@ -2754,7 +2754,7 @@ NDS_ITCM_CODE void process_sequences(UNUSED s32 iterationsRemaining) {
 #endif
         }
     }
-#if (defined(VERSION_JP) || defined(VERSION_US)) && !defined(TARGET_NDS)
+#if (defined(VERSION_JP) || defined(VERSION_US)) && !defined(TARGET_NDS) && !defined(TARGET_HOST)
     reclaim_notes();
 #endif
     process_notes();
@@ -10,6 +10,8 @@ ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(0x31200) - 0x3800];
 ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(0x31200) - 0x4800];
 #elif defined(VERSION_CN)
 ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(0x31200) - 0x4C00];
+#elif defined(TARGET_NDS) || defined(TARGET_HOST)
+ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(0x12000)];
 #else
 ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(0x31200)];
 #endif
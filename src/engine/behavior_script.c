@@ -15,6 +15,20 @@
 #include "surface_collision.h"
 
 // Macros for retrieving arguments from behavior scripts.
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+#define BHV_CMD_GET_1ST_U8(index)  (u8)((gCurBhvCommand[index].word >> 24) & 0xFF) // unused
+#define BHV_CMD_GET_2ND_U8(index)  (u8)(gCurBhvCommand[index].hi)
+#define BHV_CMD_GET_3RD_U8(index)  (u8)((u16) gCurBhvCommand[index].lo >> 8)
+#define BHV_CMD_GET_4TH_U8(index)  (u8)(gCurBhvCommand[index].lo)
+
+#define BHV_CMD_GET_1ST_S16(index) (gCurBhvCommand[index].hi)
+#define BHV_CMD_GET_2ND_S16(index) (gCurBhvCommand[index].lo)
+
+#define BHV_CMD_GET_U32(index)     (u32)(gCurBhvCommand[index].word)
+#define BHV_CMD_GET_VPTR(index)    (void *)(gCurBhvCommand[index].word)
+
+typedef struct BhvCommand BehaviorCommand;
+#else
 #define BHV_CMD_GET_1ST_U8(index)  (u8)((gCurBhvCommand[index] >> 24) & 0xFF) // unused
 #define BHV_CMD_GET_2ND_U8(index)  (u8)((gCurBhvCommand[index] >> 16) & 0xFF)
 #define BHV_CMD_GET_3RD_U8(index)  (u8)((gCurBhvCommand[index] >> 8) & 0xFF)
@@ -26,13 +40,20 @@
 #define BHV_CMD_GET_U32(index)     (u32)(gCurBhvCommand[index])
 #define BHV_CMD_GET_VPTR(index)    (void *)(gCurBhvCommand[index])
 
+typedef BehaviorScript BehaviorCommand;
+#endif
+
 #define BHV_CMD_GET_ADDR_OF_CMD(index) (uintptr_t)(&gCurBhvCommand[index])
 
 static u16 gRandomSeed16;
 
 // Unused function that directly jumps to a behavior command and resets the object's stack index.
 UNUSED static void goto_behavior_unused(const BehaviorScript *bhvAddr) {
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    gCurBhvCommand = bhv_script_decode(segmented_to_virtual(bhvAddr));
+#else
     gCurBhvCommand = segmented_to_virtual(bhvAddr);
+#endif
     gCurrentObject->bhvStackIndex = 0;
 }
 
@@ -216,7 +237,7 @@ static s32 bhv_cmd_break_unused(void) {
 // Command 0x02: Jumps to a new behavior command and stores the return address in the object's behavior stack.
 // Usage: CALL(addr)
 static s32 bhv_cmd_call(void) {
-    const BehaviorScript *jumpAddress;
+    const BehaviorCommand *jumpAddress;
     gCurBhvCommand++;
 
     cur_obj_bhv_stack_push(BHV_CMD_GET_ADDR_OF_CMD(1)); // Store address of the next bhv command in the stack.
@@ -229,7 +250,7 @@ static s32 bhv_cmd_call(void) {
 // Command 0x03: Jumps back to the behavior command stored in the object's behavior stack. Used after CALL.
 // Usage: RETURN()
 static s32 bhv_cmd_return(void) {
-    gCurBhvCommand = (const BehaviorScript *) cur_obj_bhv_stack_pop(); // Retrieve command address and jump to it.
+    gCurBhvCommand = (const BehaviorCommand *) cur_obj_bhv_stack_pop(); // Retrieve command address and jump to it.
     return BHV_PROC_CONTINUE;
 }
 
@@ -304,7 +325,7 @@ static s32 bhv_cmd_end_repeat(void) {
     count--;
 
     if (count != 0) {
-        gCurBhvCommand = (const BehaviorScript *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
+        gCurBhvCommand = (const BehaviorCommand *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
         // Save address and count to the stack again
         cur_obj_bhv_stack_push(BHV_CMD_GET_ADDR_OF_CMD(0));
         cur_obj_bhv_stack_push(count);
@@ -324,7 +345,7 @@ static s32 bhv_cmd_end_repeat_continue(void) {
     count--;
 
     if (count != 0) {
-        gCurBhvCommand = (const BehaviorScript *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
+        gCurBhvCommand = (const BehaviorCommand *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
         // Save address and count to the stack again
         cur_obj_bhv_stack_push(BHV_CMD_GET_ADDR_OF_CMD(0));
         cur_obj_bhv_stack_push(count);
@@ -349,7 +370,7 @@ static s32 bhv_cmd_begin_loop(void) {
 // Command 0x09: Marks the end of an infinite loop.
 // Usage: END_LOOP()
 static s32 bhv_cmd_end_loop(void) {
-    gCurBhvCommand = (const BehaviorScript *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
+    gCurBhvCommand = (const BehaviorCommand *) cur_obj_bhv_stack_pop(); // Jump back to the first command in the loop
     cur_obj_bhv_stack_push(BHV_CMD_GET_ADDR_OF_CMD(0)); // Save address to the stack again
 
     return BHV_PROC_BREAK;
@@ -902,6 +923,107 @@ static BhvCommandProc BehaviorCmdTable[] = {
     bhv_cmd_spawn_water_droplet,
 };
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Decoded scripts live for the whole session, since behavior scripts never change
+#define BHV_DECODE_ARENA_SIZE 0x2000
+#define BHV_DECODE_CACHE_SIZE 0x400
+
+struct BhvDecodeCacheEntry {
+    const BehaviorScript *script;
+    const struct BhvCommand *decoded;
+};
+
+// Size of each command in words. Only SET_INT_RANDOM_FROM_TABLE would have been variable, and it has no number
+static const u8 sBhvCommandSizes[BHV_CMD_COUNT] = {
+    1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, // 0x00
+    1, 1, 1, 2, 2, 2, 2, 2, 1, 1, 1, 1, 3, 1, 1, 1, // 0x10
+    1, 1, 1, 2, 1, 1, 1, 2, 1, 3, 2, 3, 3, 1, 2, 2, // 0x20
+    5, 2, 1, 2, 1, 1, 2, 2,                         // 0x30
+};
+
+static struct BhvCommand sBhvDecodeArena[BHV_DECODE_ARENA_SIZE];
+static struct BhvDecodeCacheEntry sBhvDecodeCache[BHV_DECODE_CACHE_SIZE];
+
+// Objects whose script could not be decoded stop on this instead
+static const struct BhvCommand sBhvDecodeFailed = { bhv_cmd_break, 0x0A000000, 0x0A00, 0 };
+
+struct BhvCommandStats gBhvCommandStats;
+
+// Whether a command never falls through to the word after it
+static s32 bhv_cmd_ends_script(u32 cmd) {
+    return cmd == 0x03 || cmd == 0x04 || cmd == 0x09 || cmd == 0x0A || cmd == 0x0B || cmd == 0x1D;
+}
+
+// Decode a behavior script, or the part of one a GOTO or CALL jumps into, and return its first command.
+// Scripts are decoded up to the command that ends them, and the scripts they jump to are decoded along with them.
+const struct BhvCommand *bhv_script_decode(const BehaviorScript *script) {
+    struct BhvDecodeCacheEntry *entry;
+    struct BhvCommand *decoded;
+    u32 slot = ((uintptr_t) script >> 2) & (BHV_DECODE_CACHE_SIZE - 1);
+    u32 probes;
+    u32 length = 0;
+    u32 cmd;
+    u32 i;
+
+    for (probes = 0; probes < BHV_DECODE_CACHE_SIZE; probes++) {
+        entry = &sBhvDecodeCache[slot];
+        if (entry->script == script) {
+            return entry->decoded;
+        }
+        if (entry->script == NULL) {
+            break;
+        }
+        slot = (slot + 1) & (BHV_DECODE_CACHE_SIZE - 1);
+    }
+
+    // Find where the script ends. An unknown command ends it too, and is decoded as BREAK
+    do {
+        cmd = script[length] >> 24;
+        length += (cmd < BHV_CMD_COUNT) ? sBhvCommandSizes[cmd] : 1;
+    } while (cmd < BHV_CMD_COUNT && !bhv_cmd_ends_script(cmd));
+
+    if (probes == BHV_DECODE_CACHE_SIZE || gBhvCommandStats.decodedWords + length > BHV_DECODE_ARENA_SIZE) {
+        return &sBhvDecodeFailed;
+    }
+
+    decoded = &sBhvDecodeArena[gBhvCommandStats.decodedWords];
+    gBhvCommandStats.decodedWords += length;
+
+    // Add the script to the cache before following its jumps, so scripts that jump to each other terminate
+    entry->script = script;
+    entry->decoded = decoded;
+
+    for (i = 0; i < length; i++) {
+        decoded[i].proc = NULL;
+        decoded[i].word = script[i];
+        decoded[i].hi = (s16)(script[i] >> 16);
+        decoded[i].lo = (s16)(script[i] & 0xFFFF);
+    }
+
+    for (i = 0; i < length; i += sBhvCommandSizes[cmd]) {
+        cmd = script[i] >> 24;
+        if (cmd >= BHV_CMD_COUNT) {
+            decoded[i] = sBhvDecodeFailed;
+            break;
+        }
+        decoded[i].proc = BehaviorCmdTable[cmd];
+
+        // Resolve jumps ahead of time, staying within this script when the target is part of it
+        if (cmd == 0x02 || cmd == 0x04) {
+            const BehaviorScript *target = segmented_to_virtual((const void *) script[i + 1]);
+
+            if (target >= script && target < script + length) {
+                decoded[i + 1].word = (uintptr_t) &decoded[target - script];
+            } else {
+                decoded[i + 1].word = (uintptr_t) bhv_script_decode(target);
+            }
+        }
+    }
+
+    return decoded;
+}
+#endif
+
 // Execute the behavior script of the current object, process the object flags, and other miscellaneous code for updating objects.
 void cur_obj_update(void) {
     UNUSED u8 filler[4];
@@ -933,10 +1055,19 @@ void cur_obj_update(void) {
     // Execute the behavior script.
     gCurBhvCommand = gCurrentObject->curBhvCommand;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // Each command's handler was resolved when its script was decoded
+    do {
+        gBhvCommandStats.counts[(u8)(gCurBhvCommand->word >> 24)]++;
+        bhvCmdProc = gCurBhvCommand->proc;
+        bhvProcResult = bhvCmdProc();
+    } while (bhvProcResult == BHV_PROC_CONTINUE);
+#else
     do {
         bhvCmdProc = BehaviorCmdTable[*gCurBhvCommand >> 24];
         bhvProcResult = bhvCmdProc();
     } while (bhvProcResult == BHV_PROC_CONTINUE);
+#endif
 
     gCurrentObject->curBhvCommand = gCurBhvCommand;
 
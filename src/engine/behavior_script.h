@@ -3,9 +3,34 @@
 
 #include <PR/ultratypes.h>
 
+#include "types.h"
+
 #define BHV_PROC_CONTINUE 0
 #define BHV_PROC_BREAK    1
 
+#define BHV_CMD_COUNT 0x38
+
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// One word of a decoded behavior script. Scripts are decoded word for word, so commands keep their sizes and
+// offsets, but each one has its handler resolved and its halves split out ahead of time
+struct BhvCommand {
+    s32 (*proc)(void); // Handler, for words that start a command
+    uintptr_t word;    // Raw word, except that GOTO and CALL targets point at their decoded commands
+    s16 hi;            // High half of the raw word
+    s16 lo;            // Low half of the raw word
+};
+
+// How many times each command ran, by command number
+struct BhvCommandStats {
+    u32 counts[BHV_CMD_COUNT];
+    u32 decodedWords;
+};
+
+extern struct BhvCommandStats gBhvCommandStats;
+
+const struct BhvCommand *bhv_script_decode(const BehaviorScript *script);
+#endif
+
 #define cur_obj_get_int(offset) gCurrentObject->OBJECT_FIELD_S32(offset)
 #define cur_obj_get_float(offset) gCurrentObject->OBJECT_FIELD_F32(offset)
 
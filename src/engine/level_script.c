@@ -270,13 +270,21 @@ static void level_cmd_load_to_fixed_address(void) {
 }
 
 static void level_cmd_load_raw(void) {
+#ifndef NO_SEGMENTED_MEMORY
     load_segment(CMD_GET(s16, 2), CMD_GET(void *, 4), CMD_GET(void *, 8),
             MEMORY_POOL_LEFT);
+#else
+    load_segment_file(CMD_GET(s16, 2), CMD_GET(const char *, 4));
+#endif
     sCurrentCmd = CMD_NEXT;
 }
 
 static void level_cmd_load_mio0(void) {
+#ifndef NO_SEGMENTED_MEMORY
     load_segment_decompress(CMD_GET(s16, 2), CMD_GET(void *, 4), CMD_GET(void *, 8));
+#else
+    load_segment_file(CMD_GET(s16, 2), CMD_GET(const char *, 4));
+#endif
     sCurrentCmd = CMD_NEXT;
 }
 
@@ -577,7 +577,16 @@ NDS_ITCM_CODE void mtxf_mul_vec3s(Mat4 mtx, Vec3s b) {
  * and no crashes occur.
  */
 NDS_ITCM_CODE void mtxf_to_mtx(Mtx *dest, Mat4 src) {
-#ifdef AVOID_UB
+#if defined(GBI_NATIVE_MTX)
+    // Elements stay whole and in order, so this is just a float-to-integer conversion
+    register s32 i;
+    register s32 *dst = (s32 *) dest->m;
+    register f32 *t1 = (f32 *) src;
+
+    for (i = 0; i < 16; i++) {
+        *dst++ = *t1++ * (1 << 16);
+    }
+#elif defined(AVOID_UB)
     // Avoid type-casting which is technically UB by calling the equivalent
     // guMtxF2L function. This helps little-endian systems, as well.
     guMtxF2L(src, dest);
@@ -8,6 +8,61 @@
 #include "surface_collision.h"
 #include "surface_load.h"
 
+#if defined(COLLISION_VERIFY) && !defined(FIXED_POINT_COLLISION)
+#error "COLLISION_VERIFY compares against the fixed-point backend, so it needs FIXED_POINT_COLLISION"
+#endif
+
+#ifdef FIXED_POINT_COLLISION
+#ifdef TARGET_NDS
+// The ARM9 has no FPU and no divide instruction, but it does have a memory-mapped divider, which
+// takes about 34 cycles for a 64 by 32-bit division instead of a libgcc call. It isn't used from
+// interrupts, so it's safe to use here without saving its state.
+#define REG_DIVCNT      (*(vu16 *) 0x04000280)
+#define REG_DIV_NUMER   (*(vs64 *) 0x04000290)
+#define REG_DIV_DENOM_L (*(vs32 *) 0x04000298)
+#define REG_DIV_RESULT  (*(vs64 *) 0x040002A0)
+#define DIV_64_32       1
+#define DIV_BUSY        (1 << 15)
+
+static s64 collision_div64(s64 num, s32 den) {
+    REG_DIVCNT = DIV_64_32;
+    REG_DIV_NUMER = num;
+    REG_DIV_DENOM_L = den;
+    while (REG_DIVCNT & DIV_BUSY);
+    return REG_DIV_RESULT;
+}
+#else
+#define collision_div64(num, den) ((s64)(num) / (s32)(den))
+#endif
+
+/**
+ * Convert a height found from a fixed-point plane back to units. The numerator is the plane
+ * equation without the Y term, so the height is -num / ny.
+ */
+static f32 fixed_plane_height(s64 num, s32 ny) {
+    return (f32) collision_div64(-num * COLLISION_FIXED_ONE, ny) * (1.0f / COLLISION_FIXED_ONE);
+}
+#endif
+
+#ifdef COLLISION_VERIFY
+struct CollisionVerifyStats gCollisionVerify;
+
+/**
+ * Record a query where the fixed-point and float backends disagreed, so it can be replayed.
+ */
+static void collision_verify_mismatch(char type, f32 x, f32 y, f32 z) {
+    gCollisionVerify.mismatches++;
+    gCollisionVerify.lastType = type;
+    gCollisionVerify.lastPos[0] = x;
+    gCollisionVerify.lastPos[1] = y;
+    gCollisionVerify.lastPos[2] = z;
+}
+
+// Float heights lose precision far from the origin, so small differences are expected
+#define VERIFY_EPSILON 0.05f
+#define VERIFY_DIFFERS(a, b) ((a) - (b) > VERIFY_EPSILON || (b) - (a) > VERIFY_EPSILON)
+#endif
+
 /**************************************************
  *                      WALLS                     *
  **************************************************/
@@ -16,8 +71,8 @@
  * Iterate through the list of walls until all walls are checked and
  * have given their wall push.
  */
-static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode,
-                                          struct WallCollisionData *data) {
+UNUSED static s32 find_wall_collisions_from_list_float(struct SurfaceNode *surfaceNode,
+                                                      struct WallCollisionData *data) {
     register struct Surface *surf;
     register f32 offset;
     register f32 radius = data->radius;
@@ -153,6 +208,193 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode,
     return numCols;
 }
 
+#ifdef FIXED_POINT_COLLISION
+/**
+ * Same as find_wall_collisions_from_list_float, but using the fixed-point planes. The position is
+ * converted to 17.15 fixed point once, and the only float math left is applying the push.
+ */
+static s32 find_wall_collisions_from_list_fixed(struct SurfaceNode *surfaceNode,
+                                                struct WallCollisionData *data) {
+    register struct Surface *surf;
+    register s32 offset;
+    register s32 w1, w2, w3;
+    register s32 y1, y2, y3;
+    s32 radius, x, y, z;
+    f32 posY = data->y + data->offsetY;
+    s32 numCols = 0;
+
+    // Walls only span the range of s16, so anything outside it can't collide, and this keeps the
+    // fixed-point position from overflowing.
+    if (posY < -0x8000 || posY >= 0x8000) {
+        return 0;
+    }
+
+    // Positions outside it horizontally (parallel universes) still get here, since find_wall_collisions
+    // wraps them to s16 to pick a cell, but they'd overflow the conversion, so they take the float path.
+    if (data->x < -0x8000 || data->x >= 0x8000 || data->z < -0x8000 || data->z >= 0x8000) {
+        return find_wall_collisions_from_list_float(surfaceNode, data);
+    }
+
+    // Max collision radius = 200
+    radius = (data->radius > 200.0f) ? 200 * COLLISION_FIXED_ONE : (s32)(data->radius * COLLISION_FIXED_ONE);
+    x = (s32)(data->x * COLLISION_FIXED_ONE);
+    y = (s32)(posY * COLLISION_FIXED_ONE);
+    z = (s32)(data->z * COLLISION_FIXED_ONE);
+
+    // Stay in this loop until out of walls.
+    while (surfaceNode != NULL) {
+        surf = surfaceNode->surface;
+        surfaceNode = surfaceNode->next;
+
+        // Exclude a large number of walls immediately to optimize.
+        if (y < surf->lowerY * COLLISION_FIXED_ONE || y > surf->upperY * COLLISION_FIXED_ONE) {
+            continue;
+        }
+
+        offset = (s32)(((s64) surf->normalFixed.x * x + (s64) surf->normalFixed.y * y
+                        + (s64) surf->normalFixed.z * z + surf->originOffsetFixed * COLLISION_FIXED_ONE)
+                       >> COLLISION_NORMAL_SHIFT);
+
+        if (offset < -radius || offset > radius) {
+            continue;
+        }
+
+        // The edge tests have the same sign as the float version, but are exact here, so positions
+        // along the seam of two walls can't tunnel through both.
+        if (surf->flags & SURFACE_FLAG_X_PROJECTION) {
+            w1 = -surf->vertex1[2];            w2 = -surf->vertex2[2];            w3 = -surf->vertex3[2];
+            y1 = surf->vertex1[1];            y2 = surf->vertex2[1];            y3 = surf->vertex3[1];
+
+            if (surf->normalFixed.x > 0) {
+                if ((s64)(y1 * COLLISION_FIXED_ONE - y) * (w2 - w1) - (s64)(w1 * COLLISION_FIXED_ONE + z) * (y2 - y1) > 0) {
+                    continue;
+                }
+                if ((s64)(y2 * COLLISION_FIXED_ONE - y) * (w3 - w2) - (s64)(w2 * COLLISION_FIXED_ONE + z) * (y3 - y2) > 0) {
+                    continue;
+                }
+                if ((s64)(y3 * COLLISION_FIXED_ONE - y) * (w1 - w3) - (s64)(w3 * COLLISION_FIXED_ONE + z) * (y1 - y3) > 0) {
+                    continue;
+                }
+            } else {
+                if ((s64)(y1 * COLLISION_FIXED_ONE - y) * (w2 - w1) - (s64)(w1 * COLLISION_FIXED_ONE + z) * (y2 - y1) < 0) {
+                    continue;
+                }
+                if ((s64)(y2 * COLLISION_FIXED_ONE - y) * (w3 - w2) - (s64)(w2 * COLLISION_FIXED_ONE + z) * (y3 - y2) < 0) {
+                    continue;
+                }
+                if ((s64)(y3 * COLLISION_FIXED_ONE - y) * (w1 - w3) - (s64)(w3 * COLLISION_FIXED_ONE + z) * (y1 - y3) < 0) {
+                    continue;
+                }
+            }
+        } else {
+            w1 = surf->vertex1[0];            w2 = surf->vertex2[0];            w3 = surf->vertex3[0];
+            y1 = surf->vertex1[1];            y2 = surf->vertex2[1];            y3 = surf->vertex3[1];
+
+            if (surf->normalFixed.z > 0) {
+                if ((s64)(y1 * COLLISION_FIXED_ONE - y) * (w2 - w1) - (s64)(w1 * COLLISION_FIXED_ONE - x) * (y2 - y1) > 0) {
+                    continue;
+                }
+                if ((s64)(y2 * COLLISION_FIXED_ONE - y) * (w3 - w2) - (s64)(w2 * COLLISION_FIXED_ONE - x) * (y3 - y2) > 0) {
+                    continue;
+                }
+                if ((s64)(y3 * COLLISION_FIXED_ONE - y) * (w1 - w3) - (s64)(w3 * COLLISION_FIXED_ONE - x) * (y1 - y3) > 0) {
+                    continue;
+                }
+            } else {
+                if ((s64)(y1 * COLLISION_FIXED_ONE - y) * (w2 - w1) - (s64)(w1 * COLLISION_FIXED_ONE - x) * (y2 - y1) < 0) {
+                    continue;
+                }
+                if ((s64)(y2 * COLLISION_FIXED_ONE - y) * (w3 - w2) - (s64)(w2 * COLLISION_FIXED_ONE - x) * (y3 - y2) < 0) {
+                    continue;
+                }
+                if ((s64)(y3 * COLLISION_FIXED_ONE - y) * (w1 - w3) - (s64)(w3 * COLLISION_FIXED_ONE - x) * (y1 - y3) < 0) {
+                    continue;
+                }
+            }
+        }
+
+        // Determine if checking for the camera or not.
+        if (gCheckingSurfaceCollisionsForCamera) {
+            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        } else {
+            // Ignore camera only surfaces.
+            if (surf->type == SURFACE_CAMERA_BOUNDARY) {
+                continue;
+            }
+
+            // If an object can pass through a vanish cap wall, pass through.
+            if (surf->type == SURFACE_VANISH_CAP_WALLS) {
+                // If an object can pass through a vanish cap wall, pass through.
+                if (gCurrentObject != NULL
+                    && (gCurrentObject->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE)) {
+                    continue;
+                }
+
+                // If Mario has a vanish cap, pass through the vanish cap wall.
+                if (gCurrentObject != NULL && gCurrentObject == gMarioObject
+                    && (gMarioState->flags & MARIO_VANISH_CAP)) {
+                    continue;
+                }
+            }
+        }
+
+        //! (Wall Overlaps) Because this doesn't update the x and z local variables,
+        //  multiple walls can push mario more than is required.
+        data->x += (f32)(s32)(((s64) surf->normalFixed.x * (radius - offset)) >> COLLISION_NORMAL_SHIFT)
+                   * (1.0f / COLLISION_FIXED_ONE);
+        data->z += (f32)(s32)(((s64) surf->normalFixed.z * (radius - offset)) >> COLLISION_NORMAL_SHIFT)
+                   * (1.0f / COLLISION_FIXED_ONE);
+
+        //! (Unreferenced Walls) Since this only returns the first four walls,
+        //  this can lead to wall interaction being missed.
+        if (data->numWalls < 4) {
+            data->walls[data->numWalls++] = surf;
+        }
+
+        numCols++;
+    }
+
+    return numCols;
+}
+#endif
+
+#ifdef COLLISION_VERIFY
+/**
+ * Run the wall query through both backends, keep the fixed-point result and flag any difference.
+ */
+static s32 find_wall_collisions_from_list_verify(struct SurfaceNode *surfaceNode,
+                                                 struct WallCollisionData *data) {
+    struct WallCollisionData floatData = *data;
+    s32 numCols = find_wall_collisions_from_list_fixed(surfaceNode, data);
+    s32 floatNumCols = find_wall_collisions_from_list_float(surfaceNode, &floatData);
+    s32 i;
+
+    gCollisionVerify.queries++;
+    if (numCols != floatNumCols || data->numWalls != floatData.numWalls
+        || VERIFY_DIFFERS(data->x, floatData.x) || VERIFY_DIFFERS(data->z, floatData.z)) {
+        collision_verify_mismatch('W', floatData.x, floatData.y, floatData.z);
+        return numCols;
+    }
+    for (i = 0; i < data->numWalls; i++) {
+        if (data->walls[i] != floatData.walls[i]) {
+            collision_verify_mismatch('W', floatData.x, floatData.y, floatData.z);
+            break;
+        }
+    }
+    return numCols;
+}
+#endif
+
+#if defined(COLLISION_VERIFY)
+#define find_wall_collisions_from_list find_wall_collisions_from_list_verify
+#elif defined(FIXED_POINT_COLLISION)
+#define find_wall_collisions_from_list find_wall_collisions_from_list_fixed
+#else
+#define find_wall_collisions_from_list find_wall_collisions_from_list_float
+#endif
+
 /**
  * Formats the position and wall search for find_wall_collisions.
  */
@@ -223,7 +465,7 @@ s32 find_wall_collisions(struct WallCollisionData *colData) {
 /**
  * Iterate through the list of ceilings and find the first ceiling over a given point.
  */
-static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+UNUSED static struct Surface *find_ceil_from_list_float(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
     register struct Surface *surf;
     register s32 x1, z1, x2, z2, x3, z3;
     struct Surface *ceil = NULL;
@@ -300,6 +542,99 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
     return ceil;
 }
 
+#ifdef FIXED_POINT_COLLISION
+/**
+ * Same as find_ceil_from_list_float, but using the fixed-point planes. The 78 unit buffer is
+ * checked by cross-multiplying, so only the ceiling that's returned needs a division.
+ */
+static struct Surface *find_ceil_from_list_fixed(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+    register struct Surface *surf;
+    register s32 x1, z1, x2, z2, x3, z3;
+    s32 ny;
+    s64 num;
+
+    // Stay in this loop until out of ceilings.
+    while (surfaceNode != NULL) {
+        surf = surfaceNode->surface;
+        surfaceNode = surfaceNode->next;
+
+        x1 = surf->vertex1[0];
+        z1 = surf->vertex1[2];
+        z2 = surf->vertex2[2];
+        x2 = surf->vertex2[0];
+
+        // Checking if point is in bounds of the triangle laterally.
+        if ((z1 - z) * (x2 - x1) - (x1 - x) * (z2 - z1) > 0) {
+            continue;
+        }
+
+        // Slight optimization by checking these later.
+        x3 = surf->vertex3[0];
+        z3 = surf->vertex3[2];
+        if ((z2 - z) * (x3 - x2) - (x2 - x) * (z3 - z2) > 0) {
+            continue;
+        }
+        if ((z3 - z) * (x1 - x3) - (x3 - x) * (z1 - z3) > 0) {
+            continue;
+        }
+
+        // Determine if checking for the camera or not.
+        if (gCheckingSurfaceCollisionsForCamera != 0) {
+            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        }
+        // Ignore camera only surfaces.
+        else if (surf->type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        // If a wall, ignore it. Likely a remnant, should never occur.
+        ny = surf->normalFixed.y;
+        if (ny == 0) {
+            continue;
+        }
+
+        // The ceiling height is -num / ny, and ceilings face down (ny < 0), so the height being
+        // below y - 78 flips to this when multiplied through by ny.
+        num = (s64) surf->normalFixed.x * x + (s64) surf->normalFixed.z * z + surf->originOffsetFixed;
+        if (-num > (s64)(y - 78) * ny) {
+            continue;
+        }
+
+        *pheight = fixed_plane_height(num, ny);
+        return surf;
+    }
+
+    return NULL;
+}
+#endif
+
+#ifdef COLLISION_VERIFY
+/**
+ * Run the ceiling query through both backends, keep the fixed-point result and flag any difference.
+ */
+static struct Surface *find_ceil_from_list_verify(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+    f32 floatHeight = *pheight;
+    struct Surface *ceil = find_ceil_from_list_fixed(surfaceNode, x, y, z, pheight);
+    struct Surface *floatCeil = find_ceil_from_list_float(surfaceNode, x, y, z, &floatHeight);
+
+    gCollisionVerify.queries++;
+    if (ceil != floatCeil || VERIFY_DIFFERS(*pheight, floatHeight)) {
+        collision_verify_mismatch('C', x, y, z);
+    }
+    return ceil;
+}
+#endif
+
+#if defined(COLLISION_VERIFY)
+#define find_ceil_from_list find_ceil_from_list_verify
+#elif defined(FIXED_POINT_COLLISION)
+#define find_ceil_from_list find_ceil_from_list_fixed
+#else
+#define find_ceil_from_list find_ceil_from_list_float
+#endif
+
 /**
  * Find the lowest ceiling above a given position and return the height.
  */
@@ -398,7 +733,7 @@ f32 find_floor_height_and_data(f32 xPos, f32 yPos, f32 zPos, struct FloorGeometr
 /**
  * Iterate through the list of floors and find the first floor under a given point.
  */
-static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+UNUSED static struct Surface *find_floor_from_list_float(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
     register struct Surface *surf;
     register s32 x1, z1, x2, z2, x3, z3;
     f32 nx, ny, nz;
@@ -470,6 +805,102 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
     return floor;
 }
 
+#ifdef FIXED_POINT_COLLISION
+/**
+ * Same as find_floor_from_list_float, but using the fixed-point planes. The 78 unit buffer is
+ * checked by cross-multiplying, so only the floor that's returned needs a division.
+ */
+static struct Surface *find_floor_from_list_fixed(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+    register struct Surface *surf;
+    register s32 x1, z1, x2, z2, x3, z3;
+    s32 ny;
+    s64 num;
+
+    // Iterate through the list of floors until there are no more floors.
+    while (surfaceNode != NULL) {
+        surf = surfaceNode->surface;
+        surfaceNode = surfaceNode->next;
+
+        x1 = surf->vertex1[0];
+        z1 = surf->vertex1[2];
+        x2 = surf->vertex2[0];
+        z2 = surf->vertex2[2];
+
+        // Check that the point is within the triangle bounds.
+        if ((z1 - z) * (x2 - x1) - (x1 - x) * (z2 - z1) < 0) {
+            continue;
+        }
+
+        // To slightly save on computation time, set this later.
+        x3 = surf->vertex3[0];
+        z3 = surf->vertex3[2];
+
+        if ((z2 - z) * (x3 - x2) - (x2 - x) * (z3 - z2) < 0) {
+            continue;
+        }
+        if ((z3 - z) * (x1 - x3) - (x3 - x) * (z1 - z3) < 0) {
+            continue;
+        }
+
+        // Determine if we are checking for the camera or not.
+        if (gCheckingSurfaceCollisionsForCamera != 0) {
+            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) {
+                continue;
+            }
+        }
+        // If we are not checking for the camera, ignore camera only floors.
+        else if (surf->type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        // If a wall, ignore it. Likely a remnant, should never occur.
+        ny = surf->normalFixed.y;
+        if (ny == 0) {
+            continue;
+        }
+
+        // The floor height is -num / ny, and floors face up (ny > 0), so the height being above
+        // y + 78 is the same as this when multiplied through by ny.
+        num = (s64) surf->normalFixed.x * x + (s64) surf->normalFixed.z * z + surf->originOffsetFixed;
+        if (-num > (s64)(y + 78) * ny) {
+            continue;
+        }
+
+        *pheight = fixed_plane_height(num, ny);
+        return surf;
+    }
+
+    //! (Surface Cucking) Since only the first floor is returned and not the highest,
+    //  higher floors can be "cucked" by lower floors.
+    return NULL;
+}
+#endif
+
+#ifdef COLLISION_VERIFY
+/**
+ * Run the floor query through both backends, keep the fixed-point result and flag any difference.
+ */
+static struct Surface *find_floor_from_list_verify(struct SurfaceNode *surfaceNode, s32 x, s32 y, s32 z, f32 *pheight) {
+    f32 floatHeight = *pheight;
+    struct Surface *floor = find_floor_from_list_fixed(surfaceNode, x, y, z, pheight);
+    struct Surface *floatFloor = find_floor_from_list_float(surfaceNode, x, y, z, &floatHeight);
+
+    gCollisionVerify.queries++;
+    if (floor != floatFloor || VERIFY_DIFFERS(*pheight, floatHeight)) {
+        collision_verify_mismatch('F', x, y, z);
+    }
+    return floor;
+}
+#endif
+
+#if defined(COLLISION_VERIFY)
+#define find_floor_from_list find_floor_from_list_verify
+#elif defined(FIXED_POINT_COLLISION)
+#define find_floor_from_list find_floor_from_list_fixed
+#else
+#define find_floor_from_list find_floor_from_list_float
+#endif
+
 /**
  * Find the height of the highest floor below a point.
  */
@@ -17,6 +17,15 @@
 // It doesn't match if ".0" is removed or ".f" is added
 #define FLOOR_LOWER_LIMIT_SHADOW    (FLOOR_LOWER_LIMIT + 1000.0)
 
+#ifdef FIXED_POINT_COLLISION
+// Surface normals and origin offsets are also stored in 2.30 fixed point (see struct Surface),
+// and fractional positions and heights use 17.15 fixed point
+#define COLLISION_NORMAL_SHIFT 30
+#define COLLISION_NORMAL_ONE   (1 << COLLISION_NORMAL_SHIFT)
+#define COLLISION_FIXED_SHIFT  15
+#define COLLISION_FIXED_ONE    (1 << COLLISION_FIXED_SHIFT)
+#endif
+
 struct WallCollisionData {
     /*0x00*/ f32 x, y, z;
     /*0x0C*/ f32 offsetY;
@@ -34,6 +43,18 @@ struct FloorGeometry {
     f32 originOffset;
 };
 
+#ifdef COLLISION_VERIFY
+// Results of running every query through both the fixed-point and float backends
+struct CollisionVerifyStats {
+    u32 queries;
+    u32 mismatches;
+    char lastType; // 'W'all, 'C'eiling or 'F'loor
+    f32 lastPos[3];
+};
+
+extern struct CollisionVerifyStats gCollisionVerify;
+#endif
+
 s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 radius);
 s32 find_wall_collisions(struct WallCollisionData *colData);
 f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil);
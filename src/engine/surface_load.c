@@ -1,4 +1,5 @@
 #include <PR/ultratypes.h>
+#include <string.h>
 
 #include "sm64.h"
 #include "game/ingame_menu.h"
@@ -35,6 +36,53 @@ s16 sSurfacePoolSize;
 
 u8 unused8038EEA8[0x30];
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * The surfaces each object loaded last frame, and what they were built from. Objects load their
+ * collision in the same order every frame, so a stationary object's surfaces are still in the pool
+ * where the allocator has got to when it loads again, and only need to be put back into the partition.
+ */
+struct DynamicSurfaceCache {
+    TerrainData *collisionData;
+    const BehaviorScript *behavior;
+    f32 matrix[4][3];
+    u32 generation;
+    s32 firstSurface;
+    s32 numSurfaces;
+};
+
+static struct DynamicSurfaceCache sDynamicSurfaceCache[OBJECT_POOL_CAPACITY];
+
+/**
+ * Counts the times the dynamic surfaces were cleared, so a cache entry is only used
+ * if its object loaded on the frame just before.
+ */
+static u32 sDynamicSurfaceGeneration;
+
+struct DynamicSurfaceStats gDynamicSurfaceStats;
+
+#ifdef DYNAMIC_SURFACE_VERIFY
+struct DynamicSurfaceVerifyStats gDynamicSurfaceVerify;
+#endif
+
+/**
+ * While an area's terrain is read, static surfaces are only allocated, and are put into the partition in
+ * one go afterwards. Each cell list's nodes are laid out next to each other in the node pool and merge
+ * sorted, which gives the same order as inserting the surfaces one at a time: by the height of the first
+ * vertex, then in load order.
+ */
+struct StaticSurfaceEntry {
+    struct Surface *surface;
+    s32 priority;
+};
+
+static s32 sDeferStaticSurfaces;
+
+#ifdef STATIC_SURFACE_VERIFY
+struct StaticSurfaceVerifyStats gStaticSurfaceVerify;
+#endif
+#endif
+
 /**
  * Allocate the part of the surface node pool to contain a surface node.
  */
@@ -285,6 +333,196 @@ static void add_surface(struct Surface *surface, s32 dynamic) {
     }
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * Find which of a cell's lists a surface goes in, and the priority it's sorted by there.
+ * This matches add_surface_to_cell, including the wall projection flag.
+ */
+static s32 surface_list_index(struct Surface *surface, s32 *priority) {
+    if (surface->normal.y > 0.01) {
+        *priority = (s16) (surface->vertex1[1] * 1);
+        return SPATIAL_PARTITION_FLOORS;
+    } else if (surface->normal.y < -0.01) {
+        *priority = (s16) (surface->vertex1[1] * -1);
+        return SPATIAL_PARTITION_CEILS;
+    }
+
+    if (surface->normal.x < -0.707 || surface->normal.x > 0.707) {
+        surface->flags |= SURFACE_FLAG_X_PROJECTION;
+    }
+    *priority = 0;
+    return SPATIAL_PARTITION_WALLS;
+}
+
+/**
+ * Stable bottom-up merge sort, highest priority first.
+ */
+static void sort_surface_entries(struct StaticSurfaceEntry *entries, struct StaticSurfaceEntry *scratch, s32 count) {
+    struct StaticSurfaceEntry *src = entries;
+    struct StaticSurfaceEntry *dst = scratch;
+    struct StaticSurfaceEntry *swap;
+    s32 width, lo, mid, hi, i, j, k;
+
+    for (width = 1; width < count; width *= 2) {
+        for (lo = 0; lo < count; lo += 2 * width) {
+            mid = (lo + width < count) ? lo + width : count;
+            hi = (lo + 2 * width < count) ? lo + 2 * width : count;
+            i = lo;
+            j = mid;
+            k = lo;
+
+            // Only take from the right run when it's strictly higher, so ties keep their order
+            while (i < mid && j < hi) {
+                dst[k++] = (src[j].priority > src[i].priority) ? src[j++] : src[i++];
+            }
+            while (i < mid) {
+                dst[k++] = src[i++];
+            }
+            while (j < hi) {
+                dst[k++] = src[j++];
+            }
+        }
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != entries) {
+        memcpy(entries, src, count * sizeof(*entries));
+    }
+}
+
+/**
+ * Build the static partition from all of the surfaces loaded so far.
+ */
+static void partition_static_surfaces(void) {
+    static u16 listStart[NUM_CELLS][NUM_CELLS][3];
+    static u16 listEnd[NUM_CELLS][NUM_CELLS][3];
+    struct StaticSurfaceEntry *entries;
+    struct StaticSurfaceEntry *entry;
+    struct SurfaceNode *node;
+    struct Surface *surface;
+    s32 numSurfaces = gSurfacesAllocated;
+    s32 total = 0;
+    s32 i, listIndex, priority, count;
+    s16 minCellX, minCellZ, maxCellX, maxCellZ;
+    s16 cellX, cellZ;
+
+    // Count the nodes each list gets
+    memset(listEnd, 0, sizeof(listEnd));
+    for (i = 0; i < numSurfaces; i++) {
+        surface = &sSurfacePool[i];
+        listIndex = surface_list_index(surface, &priority);
+
+        minCellX = lower_cell_index(min_3(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0]));
+        maxCellX = upper_cell_index(max_3(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0]));
+        minCellZ = lower_cell_index(min_3(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2]));
+        maxCellZ = upper_cell_index(max_3(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2]));
+
+        for (cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
+            for (cellX = minCellX; cellX <= maxCellX; cellX++) {
+                listEnd[cellZ][cellX][listIndex]++;
+                total++;
+            }
+        }
+    }
+
+    // Without room for the sort, or if the node pool would overflow, insert them one at a time like before
+    entries = (total <= 7000) ? main_pool_alloc(2 * total * sizeof(*entries) + 1, MEMORY_POOL_RIGHT) : NULL;
+    if (entries == NULL) {
+        for (i = 0; i < numSurfaces; i++) {
+            add_surface(&sSurfacePool[i], FALSE);
+        }
+        return;
+    }
+
+    // Give each list its range of nodes
+    count = 0;
+    for (i = 0; i < NUM_CELLS * NUM_CELLS * 3; i++) {
+        (&listStart[0][0][0])[i] = count;
+        count += (&listEnd[0][0][0])[i];
+        (&listEnd[0][0][0])[i] = (&listStart[0][0][0])[i];
+    }
+
+    // Fill the lists in load order
+    for (i = 0; i < numSurfaces; i++) {
+        surface = &sSurfacePool[i];
+        listIndex = surface_list_index(surface, &priority);
+
+        minCellX = lower_cell_index(min_3(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0]));
+        maxCellX = upper_cell_index(max_3(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0]));
+        minCellZ = lower_cell_index(min_3(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2]));
+        maxCellZ = upper_cell_index(max_3(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2]));
+
+        for (cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
+            for (cellX = minCellX; cellX <= maxCellX; cellX++) {
+                entry = &entries[listEnd[cellZ][cellX][listIndex]++];
+                entry->surface = surface;
+                entry->priority = priority;
+            }
+        }
+    }
+
+    // Sort each list and link its nodes; walls are kept in load order
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < 3; listIndex++) {
+                s32 start = listStart[cellZ][cellX][listIndex];
+                count = listEnd[cellZ][cellX][listIndex] - start;
+                if (count == 0) {
+                    continue;
+                }
+
+                if (listIndex != SPATIAL_PARTITION_WALLS) {
+                    sort_surface_entries(&entries[start], &entries[total + start], count);
+                }
+
+                node = &sSurfaceNodePool[start];
+                for (i = 0; i < count; i++) {
+                    node[i].surface = entries[start + i].surface;
+                    node[i].next = (i + 1 < count) ? &node[i + 1] : NULL;
+                }
+                gStaticSurfacePartition[cellZ][cellX][listIndex].next = node;
+            }
+        }
+    }
+
+    gSurfaceNodesAllocated = total;
+    main_pool_free(entries);
+
+#ifdef STATIC_SURFACE_VERIFY
+    // Sorted insertion leaves each list ordered by priority, with ties in load order, which is their order
+    // in the surface pool; there's no room in the node pool to build the lists that way as well, so check that
+    for (cellZ = 0; cellZ < NUM_CELLS; cellZ++) {
+        for (cellX = 0; cellX < NUM_CELLS; cellX++) {
+            for (listIndex = 0; listIndex < 3; listIndex++) {
+                s32 prevPriority = 0;
+                struct Surface *prev = NULL;
+                s32 ordered = TRUE;
+
+                for (node = gStaticSurfacePartition[cellZ][cellX][listIndex].next; node != NULL; node = node->next) {
+                    if (surface_list_index(node->surface, &priority) != listIndex) {
+                        ordered = FALSE;
+                    } else if (prev != NULL && (priority > prevPriority
+                                                || (priority == prevPriority && node->surface <= prev))) {
+                        ordered = FALSE;
+                    }
+                    prev = node->surface;
+                    prevPriority = priority;
+                }
+
+                gStaticSurfaceVerify.lists++;
+                if (!ordered) {
+                    gStaticSurfaceVerify.mismatches++;
+                }
+            }
+        }
+    }
+#endif
+}
+#endif
+
 UNUSED static void stub_surface_load_1(void) {
 }
 
@@ -371,6 +609,16 @@ static struct Surface *read_surface_data(TerrainData *vertexData, TerrainData **
 
     surface->originOffset = -(nx * x1 + ny * y1 + nz * z1);
 
+#ifdef FIXED_POINT_COLLISION
+    // Quantize the normal once here, and derive the origin offset from the quantized normal so
+    // vertex 1 lies exactly on the fixed-point plane
+    surface->normalFixed.x = (s32)(nx * COLLISION_NORMAL_ONE);
+    surface->normalFixed.y = (s32)(ny * COLLISION_NORMAL_ONE);
+    surface->normalFixed.z = (s32)(nz * COLLISION_NORMAL_ONE);
+    surface->originOffsetFixed = -((s64) surface->normalFixed.x * x1 + (s64) surface->normalFixed.y * y1
+                                   + (s64) surface->normalFixed.z * z1);
+#endif
+
     surface->lowerY = minY - 5;
     surface->upperY = maxY + 5;
 
@@ -457,7 +705,13 @@ static void load_static_surfaces(TerrainData **data, TerrainData *vertexData, Te
                 surface->force = 0;
             }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+            if (!sDeferStaticSurfaces) {
+                add_surface(surface, FALSE);
+            }
+#else
             add_surface(surface, FALSE);
+#endif
         }
 
         *data += 3;
@@ -592,6 +846,10 @@ void load_area_terrain(s16 index, TerrainData *data, RoomData *surfaceRooms, s16
     unused8038BE90 = 0;
     gSurfaceNodesAllocated = 0;
     gSurfacesAllocated = 0;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    sDynamicSurfaceGeneration++;
+    sDeferStaticSurfaces = TRUE;
+#endif
 
     clear_static_surfaces();
 
@@ -621,6 +879,11 @@ void load_area_terrain(s16 index, TerrainData *data, RoomData *surfaceRooms, s16
         }
     }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    sDeferStaticSurfaces = FALSE;
+    partition_static_surfaces();
+#endif
+
     if (macroObjects != NULL && *macroObjects != -1) {
         // If the first macro object presetID is within the range [0, 29].
         // Generally an early spawning method, every object is in BBH (the first level).
@@ -646,6 +909,9 @@ void clear_dynamic_surfaces(void) {
         gSurfaceNodesAllocated = gNumStaticSurfaceNodes;
 
         clear_spatial_partition(&gDynamicSurfacePartition[0][0]);
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        sDynamicSurfaceGeneration++;
+#endif
     }
 }
 
@@ -748,6 +1014,96 @@ void load_object_surfaces(TerrainData **data, TerrainData *vertexData) {
     }
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * Load the surfaces for the gCurrentObject, reusing the ones it loaded last frame if it hasn't
+ * moved since. Reused surfaces are added to the partition again in the same order, so the
+ * partition ends up the same as if they were rebuilt.
+ */
+static void load_cached_object_surfaces(TerrainData *collisionData, TerrainData *vertexData) {
+    struct DynamicSurfaceCache *cache = NULL;
+    u32 slot = gCurrentObject - gObjectPool;
+    Mat4 m;
+    s32 i;
+#ifdef DYNAMIC_SURFACE_VERIFY
+    static struct Surface reused[512];
+    s32 numReused = -1;
+#endif
+
+    if (slot < OBJECT_POOL_CAPACITY) {
+        cache = &sDynamicSurfaceCache[slot];
+
+        // Build the same matrix transform_object_vertices uses
+        if (gCurrentObject->header.gfx.throwMatrix == NULL) {
+            gCurrentObject->header.gfx.throwMatrix = &gCurrentObject->transform;
+            obj_build_transform_from_pos_and_angle(gCurrentObject, O_POS_INDEX, O_FACE_ANGLE_INDEX);
+        }
+        obj_apply_scale_to_matrix(gCurrentObject, m, gCurrentObject->transform);
+
+        for (i = 0; i < 4; i++) {
+            if (cache->matrix[i][0] != m[i][0] || cache->matrix[i][1] != m[i][1]
+                || cache->matrix[i][2] != m[i][2]) {
+                break;
+            }
+        }
+
+        if (i == 4 && cache->generation + 1 == sDynamicSurfaceGeneration
+            && cache->firstSurface == gSurfacesAllocated && cache->collisionData == collisionData
+            && cache->behavior == gCurrentObject->behavior) {
+            cache->generation = sDynamicSurfaceGeneration;
+#ifdef DYNAMIC_SURFACE_VERIFY
+            // Rebuild the surfaces anyway, and compare them with the ones that would have been reused
+            if (cache->numSurfaces <= ARRAY_COUNT(reused)) {
+                numReused = cache->numSurfaces;
+                memcpy(reused, &sSurfacePool[cache->firstSurface], numReused * sizeof(struct Surface));
+            }
+#else
+            gSurfacesAllocated += cache->numSurfaces;
+            for (i = 0; i < cache->numSurfaces; i++) {
+                add_surface(&sSurfacePool[cache->firstSurface + i], TRUE);
+            }
+
+            gDynamicSurfaceStats.reused += cache->numSurfaces;
+            return;
+#endif
+        }
+
+        cache->collisionData = collisionData;
+        cache->behavior = gCurrentObject->behavior;
+        for (i = 0; i < 4; i++) {
+            cache->matrix[i][0] = m[i][0];
+            cache->matrix[i][1] = m[i][1];
+            cache->matrix[i][2] = m[i][2];
+        }
+        cache->generation = sDynamicSurfaceGeneration;
+        cache->firstSurface = gSurfacesAllocated;
+    }
+
+    i = gSurfacesAllocated;
+    transform_object_vertices(&collisionData, vertexData);
+
+    // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
+    while (*collisionData != TERRAIN_LOAD_CONTINUE) {
+        load_object_surfaces(&collisionData, vertexData);
+    }
+
+    gDynamicSurfaceStats.rebuilt += gSurfacesAllocated - i;
+    if (cache != NULL) {
+        cache->numSurfaces = gSurfacesAllocated - i;
+    }
+
+#ifdef DYNAMIC_SURFACE_VERIFY
+    if (numReused >= 0) {
+        gDynamicSurfaceVerify.surfaces += numReused;
+        if (numReused != gSurfacesAllocated - i
+            || memcmp(reused, &sSurfacePool[i], numReused * sizeof(struct Surface))) {
+            gDynamicSurfaceVerify.mismatches++;
+        }
+    }
+#endif
+}
+#endif
+
 /**
  * Transform an object's vertices, reload them, and render the object.
  */
@@ -775,12 +1131,16 @@ void load_object_collision_model(void) {
     if (!(gTimeStopState & TIME_STOP_ACTIVE) && marioDist < tangibleDist
         && !(gCurrentObject->activeFlags & ACTIVE_FLAG_IN_DIFFERENT_ROOM)) {
         collisionData++;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        load_cached_object_surfaces(collisionData, vertexData);
+#else
         transform_object_vertices(&collisionData, vertexData);
 
         // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
         while (*collisionData != TERRAIN_LOAD_CONTINUE) {
             load_object_surfaces(&collisionData, vertexData);
         }
+#endif
     }
 
     if (marioDist < gCurrentObject->oDrawingDistance) {
@@ -31,6 +31,36 @@ extern struct SurfaceNode *sSurfaceNodePool;
 extern struct Surface *sSurfacePool;
 extern s16 sSurfacePoolSize;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Object surfaces rebuilt from their collision data, and ones reused from the frame before
+struct DynamicSurfaceStats {
+    u32 rebuilt;
+    u32 reused;
+};
+
+extern struct DynamicSurfaceStats gDynamicSurfaceStats;
+
+#ifdef DYNAMIC_SURFACE_VERIFY
+// Object surfaces that would have been reused, and the objects whose rebuilt surfaces differed from them
+struct DynamicSurfaceVerifyStats {
+    u32 surfaces;
+    u32 mismatches;
+};
+
+extern struct DynamicSurfaceVerifyStats gDynamicSurfaceVerify;
+#endif
+
+#ifdef STATIC_SURFACE_VERIFY
+// Static partition lists checked against inserting the surfaces one at a time, and the ones that differed
+struct StaticSurfaceVerifyStats {
+    u32 lists;
+    u32 mismatches;
+};
+
+extern struct StaticSurfaceVerifyStats gStaticSurfaceVerify;
+#endif
+#endif
+
 void alloc_surface_pools(void);
 #ifdef NO_SEGMENTED_MEMORY
 u32 get_area_terrain_size(TerrainData *data);
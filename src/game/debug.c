@@ -1,4 +1,5 @@
 #include <PR/ultratypes.h>
+#include <PR/os_time.h>
 
 #include "behavior_data.h"
 #include "debug.h"
@@ -76,15 +77,23 @@ void stub_debug_4(void) {
  * its difference for consecutive calls.
  */
 s64 get_current_clock(void) {
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    return osGetTime();
+#else
     s64 wtf = 0;
 
     return wtf;
+#endif
 }
 
 s64 get_clock_difference(UNUSED s64 cycles) {
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    return osGetTime() - cycles;
+#else
     s64 wtf = 0;
 
     return wtf;
+#endif
 }
 
 /*
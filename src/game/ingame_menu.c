@@ -1,4 +1,5 @@
 #include <ultra64.h>
+#include <string.h>
 
 #include "actors/common1.h"
 #include "area.h"
@@ -137,7 +138,7 @@ void create_dl_identity_matrix(void) {
         return;
     }
 
-#ifndef GBI_FLOATS
+#if !defined(GBI_FLOATS) && !defined(GBI_NATIVE_MTX)
     matrix->m[0][0] = 0x00010000;    matrix->m[1][0] = 0x00000000;    matrix->m[2][0] = 0x00000000;    matrix->m[3][0] = 0x00000000;
     matrix->m[0][1] = 0x00000000;    matrix->m[1][1] = 0x00010000;    matrix->m[2][1] = 0x00000000;    matrix->m[3][1] = 0x00000000;
     matrix->m[0][2] = 0x00000001;    matrix->m[1][2] = 0x00000000;    matrix->m[2][2] = 0x00000000;    matrix->m[3][2] = 0x00000000;
@@ -282,6 +283,58 @@ static u8 *alloc_ia8_text_from_i1(u16 *in, s16 width, s16 height) {
 }
 #endif
 
+#if (defined(TARGET_NDS) || defined(TARGET_HOST)) && defined(VERSION_US)
+// Every glyph of the dialog font is copied into rows of one 16x1024 texture, so text only needs a single texture in
+// VRAM and the renderer doesn't have to rebind it between characters
+// Each glyph takes 8 rows; texture coordinates for the 128th row wouldn't fit in a vertex, so only 127 are used
+#define GLYPH_ATLAS_ROWS 1024
+#define GLYPH_ATLAS_SLOTS 127
+#define GLYPH_SIZE (16 * 8) // Glyphs are converted to 8-bit IA at build time
+
+ALIGNED8 static u8 sGlyphAtlas[16 * GLYPH_ATLAS_ROWS];
+static Vtx sGlyphVertices[GLYPH_ATLAS_SLOTS][4];
+static u8 sGlyphSlots[256]; // Atlas slot plus one for each character, or 0 if it isn't in the atlas
+static u8 sGlyphAtlasReady = FALSE;
+
+static const Gfx dl_ia_text_atlas_settings[] = {
+    gsDPSetTile(G_IM_FMT_IA, G_IM_SIZ_16b, 0, 0, G_TX_LOADTILE, 0, G_TX_WRAP | G_TX_NOMIRROR, 10, G_TX_NOLOD, G_TX_WRAP | G_TX_NOMIRROR, 4, G_TX_NOLOD),
+    gsDPLoadSync(),
+    gsDPLoadBlock(G_TX_LOADTILE, 0, 0, ((16 * GLYPH_ATLAS_ROWS + G_IM_SIZ_4b_INCR) >> G_IM_SIZ_4b_SHIFT) - 1, CALC_DXT(16, G_IM_SIZ_4b_BYTES)),
+    gsDPSetTile(G_IM_FMT_IA, G_IM_SIZ_4b, 1, 0, G_TX_RENDERTILE, 0, G_TX_WRAP | G_TX_NOMIRROR, 10, G_TX_NOLOD, G_TX_WRAP | G_TX_NOMIRROR, 4, G_TX_NOLOD),
+    gsDPSetTileSize(0, 0, 0, (16 - 1) << G_TEXTURE_IMAGE_FRAC, (GLYPH_ATLAS_ROWS - 1) << G_TEXTURE_IMAGE_FRAC),
+    gsSPEndDisplayList(),
+};
+
+static void init_glyph_atlas(void) {
+    void **fontLUT = segmented_to_virtual(main_font_lut);
+    s32 slot = 0;
+    s32 c;
+    s32 i;
+
+    for (c = 0; c < 256 && slot < GLYPH_ATLAS_SLOTS; c++) {
+        if (fontLUT[c] == NULL) {
+            continue;
+        }
+
+        memcpy(&sGlyphAtlas[slot * GLYPH_SIZE], segmented_to_virtual(fontLUT[c]), GLYPH_SIZE);
+
+        // Same quad as vertex_ia8_char, moved down to the glyph's rows
+        for (i = 0; i < 4; i++) {
+            Vtx_t *v = &sGlyphVertices[slot][i].v;
+            v->ob[0] = (i == 1 || i == 2) ? 8 : 0;
+            v->ob[1] = (i >= 2) ? 16 : 0;
+            v->tc[0] = (i >= 2) ? 480 : 0;
+            v->tc[1] = ((i == 0 || i == 3) ? 256 : 0) + slot * 256;
+            v->cn[0] = v->cn[1] = v->cn[2] = v->cn[3] = 0xFF;
+        }
+
+        sGlyphSlots[c] = ++slot;
+    }
+
+    sGlyphAtlasReady = TRUE;
+}
+#endif
+
 #ifdef VERSION_CN
 void render_generic_char(u16 c)
 #else
@@ -294,6 +347,21 @@ void render_generic_char(u8 c)
     void *unpackedTexture = alloc_ia8_text_from_i1(packedTexture, 8, 16);
 #endif
 
+#if (defined(TARGET_NDS) || defined(TARGET_HOST)) && defined(VERSION_US)
+    if (!sGlyphAtlasReady) {
+        init_glyph_atlas();
+    }
+
+    if (sGlyphSlots[c] != 0) {
+        gDPPipeSync(gDisplayListHead++);
+        gDPSetTextureImage(gDisplayListHead++, G_IM_FMT_IA, G_IM_SIZ_16b, 1, VIRTUAL_TO_PHYSICAL(sGlyphAtlas));
+        gSPDisplayList(gDisplayListHead++, dl_ia_text_atlas_settings);
+        gSPVertex(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(sGlyphVertices[sGlyphSlots[c] - 1]), 4, 0);
+        gSP2Triangles(gDisplayListHead++, 0, 1, 2, 0x0, 0, 2, 3, 0x0);
+        return;
+    }
+#endif
+
 #ifndef VERSION_EU
     gDPPipeSync(gDisplayListHead++);
 #endif
@@ -391,7 +391,7 @@ void dispatch_audio_sptask(struct SPTask *spTask) {
     }
 }
 
-#ifndef TARGET_NDS
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
 void exec_display_list(struct SPTask *spTask) {
     if (spTask != NULL) {
         osWritebackDCacheAll();
@@ -13,6 +13,7 @@
 #include "game_init.h"
 #include "main.h"
 #include "memory.h"
+#include "rendering_graph_node.h"
 #include "segments.h"
 #include "segment_symbols.h"
 
@@ -21,6 +22,12 @@
 #define ALIGN8(val) (((val) + 0x7) & ~0x7)
 #define ALIGN16(val) (((val) + 0xF) & ~0xF)
 
+#ifdef TARGET_HOST
+#define COUNT_ALLOC(kind, size) (gMemoryAllocStats.count[kind]++, gMemoryAllocStats.bytes[kind] += (size))
+#else
+#define COUNT_ALLOC(kind, size)
+#endif
+
 struct MainPoolState {
     u32 freeSpace;
     struct MainPoolBlock *listHeadL;
@@ -59,6 +66,10 @@ extern struct MainPoolBlock *sPoolListHeadR;
  */
 struct MemoryPool *gEffectsMemoryPool;
 
+#ifdef TARGET_HOST
+struct MemoryAllocStats gMemoryAllocStats;
+#endif
+
 FORCE_BSS uintptr_t sSegmentTable[32];
 FORCE_BSS u32 sPoolFreeSpace;
 FORCE_BSS u8 *sPoolStart;
@@ -68,6 +79,7 @@ FORCE_BSS struct MainPoolBlock *sPoolListHeadR;
 
 static struct MainPoolState *gMainPoolState = NULL;
 
+#ifndef NO_SEGMENTED_MEMORY
 uintptr_t set_segment_base_addr(s32 segment, void *addr) {
     sSegmentTable[segment] = (uintptr_t) addr & 0x1FFFFFFF;
     return sSegmentTable[segment];
@@ -76,6 +88,17 @@ uintptr_t set_segment_base_addr(s32 segment, void *addr) {
 void *get_segment_base_addr(s32 segment) {
     return (void *) (sSegmentTable[segment] | 0x80000000);
 }
+#else
+// Streamed segments are loaded anywhere in RAM, so their addresses are kept as they are
+uintptr_t set_segment_base_addr(s32 segment, void *addr) {
+    sSegmentTable[segment] = (uintptr_t) addr;
+    return sSegmentTable[segment];
+}
+
+void *get_segment_base_addr(s32 segment) {
+    return (void *) sSegmentTable[segment];
+}
+#endif
 
 #ifndef NO_SEGMENTED_MEMORY
 void *segmented_to_virtual(const void *addr) {
@@ -160,6 +183,7 @@ void *main_pool_alloc(u32 size, u32 side) {
             sPoolListHeadR = newListHead;
             addr = (u8 *) sPoolListHeadR + 16;
         }
+        COUNT_ALLOC(ALLOC_MAIN_POOL, size);
     }
     return addr;
 }
@@ -419,6 +443,7 @@ void *alloc_only_pool_alloc(struct AllocOnlyPool *pool, s32 size) {
         addr = pool->freePtr;
         pool->freePtr += size;
         pool->usedSpace += size;
+        COUNT_ALLOC(ALLOC_ONLY_POOL, size);
     }
     return addr;
 }
@@ -486,6 +511,7 @@ void *mem_pool_alloc(struct MemoryPool *pool, u32 size) {
                 freeBlock->next->size = size;
                 freeBlock->next = newBlock;
             }
+            COUNT_ALLOC(ALLOC_MEM_POOL, size);
             break;
         }
         freeBlock = freeBlock->next;
@@ -546,6 +572,7 @@ void *alloc_display_list(u32 size) {
     if (gGfxPoolEnd - size >= (u8 *) gDisplayListHead) {
         gGfxPoolEnd -= size;
         ptr = gGfxPoolEnd;
+        COUNT_ALLOC(ALLOC_DISPLAY_LIST, size);
     } else {
     }
     return ptr;
@@ -583,6 +610,10 @@ s32 load_patchable_table(struct DmaHandlerList *list, s32 index) {
             dma_read(list->bufTarget, addr, addr + size);
             list->currentAddr = addr;
             ret = TRUE;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+            // Animations in the old contents may have been posed at the same addresses
+            pose_cache_invalidate();
+#endif
         }
     }
     return ret;
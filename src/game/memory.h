@@ -34,6 +34,26 @@ struct DmaHandlerList {
     void *bufTarget;
 };
 
+#ifdef TARGET_HOST
+enum MemoryAllocKind {
+    ALLOC_MAIN_POOL,
+    ALLOC_ONLY_POOL,
+    ALLOC_MEM_POOL,
+    ALLOC_DISPLAY_LIST,
+    ALLOC_KIND_COUNT
+};
+
+/**
+ * Successful allocations of each kind, counted for the host benchmark.
+ */
+struct MemoryAllocStats {
+    u32 count[ALLOC_KIND_COUNT];
+    u32 bytes[ALLOC_KIND_COUNT];
+};
+
+extern struct MemoryAllocStats gMemoryAllocStats;
+#endif
+
 #ifndef INCLUDED_FROM_MEMORY_C
 // Declaring this variable extern puts it in the wrong place in the bss order
 // when this file is included from memory.c (first instead of last). Hence,
@@ -62,6 +82,7 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd);
 void *load_segment_decompress_heap(u32 segment, u8 *srcStart, u8 *srcEnd);
 void load_engine_code_segment(void);
 #else
+void *load_segment_file(s32 segment, const char *symbol);
 #define load_segment(...)
 #define load_to_fixed_pool_addr(...)
 #define load_segment_decompress(...)
@@ -1,12 +1,79 @@
 #include <PR/ultratypes.h>
+#include <string.h>
 
 #include "sm64.h"
 #include "debug.h"
 #include "interaction.h"
 #include "mario.h"
+#include "object_collision.h"
 #include "object_list_processor.h"
 #include "spawn_object.h"
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Conservative bounds of each object's hitbox on the XZ plane, in whole units rounded outwards and indexed by pool
+// slot; they're built once per frame while collision state is cleared, so pairs that are far apart can be rejected
+// with integer compares instead of going through the float distance check. Pairs are still visited in the same
+// order, and rejected pairs could never overlap, so the collided objects and their order don't change
+#define BOUNDS_LIMIT 0x40000000
+
+struct HitboxBounds {
+    s32 minX;
+    s32 maxX;
+    s32 minZ;
+    s32 maxZ;
+};
+
+static struct HitboxBounds sHitboxBounds[OBJECT_POOL_CAPACITY];
+
+#ifdef OBJ_COLLISION_VERIFY
+struct ObjCollisionVerifyStats gObjCollisionVerify;
+static s32 sBroadphaseEnabled = TRUE;
+#endif
+
+static s32 bounds_min(f32 value) {
+    // Values out of range (or NaN) give bounds that overlap everything
+    return (value > -BOUNDS_LIMIT) ? (s32) value - 1 : -BOUNDS_LIMIT;
+}
+
+static s32 bounds_max(f32 value) {
+    return (value < BOUNDS_LIMIT) ? (s32) value + 1 : BOUNDS_LIMIT;
+}
+
+static void update_hitbox_bounds(struct Object *obj) {
+    u32 slot = obj - gObjectPool;
+    if (slot < OBJECT_POOL_CAPACITY) {
+        struct HitboxBounds *bounds = &sHitboxBounds[slot];
+        bounds->minX = bounds_min(obj->oPosX - obj->hitboxRadius);
+        bounds->maxX = bounds_max(obj->oPosX + obj->hitboxRadius);
+        bounds->minZ = bounds_min(obj->oPosZ - obj->hitboxRadius);
+        bounds->maxZ = bounds_max(obj->oPosZ + obj->hitboxRadius);
+    }
+}
+
+static s32 hitbox_bounds_overlap(struct Object *a, struct Object *b) {
+    u32 slotA = a - gObjectPool;
+    u32 slotB = b - gObjectPool;
+    struct HitboxBounds *boundsA;
+    struct HitboxBounds *boundsB;
+
+#ifdef OBJ_COLLISION_VERIFY
+    if (!sBroadphaseEnabled) {
+        return TRUE;
+    }
+#endif
+
+    // Objects outside the pool always go through the full check
+    if (slotA >= OBJECT_POOL_CAPACITY || slotB >= OBJECT_POOL_CAPACITY) {
+        return TRUE;
+    }
+
+    boundsA = &sHitboxBounds[slotA];
+    boundsB = &sHitboxBounds[slotB];
+    return boundsA->minX <= boundsB->maxX && boundsB->minX <= boundsA->maxX
+        && boundsA->minZ <= boundsB->maxZ && boundsB->minZ <= boundsA->maxZ;
+}
+#endif
+
 struct Object *debug_print_obj_collision(struct Object *a) {
     struct Object *sp24;
     UNUSED u8 filler[4];
@@ -106,6 +173,9 @@ void clear_object_collision(struct Object *a) {
         if (sp4->oIntangibleTimer > 0) {
             sp4->oIntangibleTimer--;
         }
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        update_hitbox_bounds(sp4);
+#endif
         sp4 = (struct Object *) sp4->header.next;
     }
 }
@@ -113,7 +183,11 @@ void clear_object_collision(struct Object *a) {
 void check_collision_in_list(struct Object *a, struct Object *b, struct Object *c) {
     if (a->oIntangibleTimer == 0) {
         while (b != c) {
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+            if (b->oIntangibleTimer == 0 && hitbox_bounds_overlap(a, b)) {
+#else
             if (b->oIntangibleTimer == 0) {
+#endif
                 if (detect_object_hitbox_overlap(a, b) && b->hurtboxRadius != 0.0f) {
                     detect_object_hurtbox_overlap(a, b);
                 }
@@ -173,6 +247,75 @@ void check_destructive_object_collision(void) {
     }
 }
 
+#ifdef OBJ_COLLISION_VERIFY
+// The collision results of every pool slot, and the one field the checks change besides them
+struct CollisionResult {
+    s16 numCollidedObjs;
+    struct Object *collidedObjs[4];
+    u32 collidedObjInteractTypes;
+    u32 interactionSubtype;
+};
+
+static void save_collision_results(struct CollisionResult *results) {
+    s32 i;
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        results[i].numCollidedObjs = gObjectPool[i].numCollidedObjs;
+        memcpy(results[i].collidedObjs, gObjectPool[i].collidedObjs, sizeof(results[i].collidedObjs));
+        results[i].collidedObjInteractTypes = gObjectPool[i].collidedObjInteractTypes;
+        results[i].interactionSubtype = gObjectPool[i].oInteractionSubtype;
+    }
+}
+
+static void load_collision_results(struct CollisionResult *results) {
+    s32 i;
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        gObjectPool[i].numCollidedObjs = results[i].numCollidedObjs;
+        memcpy(gObjectPool[i].collidedObjs, results[i].collidedObjs, sizeof(results[i].collidedObjs));
+        gObjectPool[i].collidedObjInteractTypes = results[i].collidedObjInteractTypes;
+        gObjectPool[i].oInteractionSubtype = results[i].interactionSubtype;
+    }
+}
+
+static void verify_object_collisions(void) {
+    // Run the checks once without the broadphase and once with it, from the same starting state, and compare
+    // the collided objects of every slot; only the entries in use are compared, since the rest are stale
+    static struct CollisionResult start[OBJECT_POOL_CAPACITY];
+    static struct CollisionResult expected[OBJECT_POOL_CAPACITY];
+    static struct CollisionResult actual[OBJECT_POOL_CAPACITY];
+    s32 mismatch = FALSE;
+    s32 i;
+
+    save_collision_results(start);
+    sBroadphaseEnabled = FALSE;
+    check_player_object_collision();
+    check_destructive_object_collision();
+    check_pushable_object_collision();
+    save_collision_results(expected);
+
+    load_collision_results(start);
+    sBroadphaseEnabled = TRUE;
+    check_player_object_collision();
+    check_destructive_object_collision();
+    check_pushable_object_collision();
+    save_collision_results(actual);
+
+    for (i = 0; i < OBJECT_POOL_CAPACITY; i++) {
+        if (expected[i].numCollidedObjs != actual[i].numCollidedObjs
+            || memcmp(expected[i].collidedObjs, actual[i].collidedObjs,
+                      expected[i].numCollidedObjs * sizeof(struct Object *))
+            || expected[i].collidedObjInteractTypes != actual[i].collidedObjInteractTypes
+            || expected[i].interactionSubtype != actual[i].interactionSubtype) {
+            mismatch = TRUE;
+        }
+    }
+
+    gObjCollisionVerify.frames++;
+    if (mismatch) {
+        gObjCollisionVerify.mismatches++;
+    }
+}
+#endif
+
 void detect_object_collisions(void) {
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_POLELIKE]);
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PLAYER]);
@@ -181,7 +324,11 @@ void detect_object_collisions(void) {
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_LEVEL]);
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_SURFACE]);
     clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_DESTRUCTIVE]);
+#ifdef OBJ_COLLISION_VERIFY
+    verify_object_collisions();
+#else
     check_player_object_collision();
     check_destructive_object_collision();
     check_pushable_object_collision();
+#endif
 }
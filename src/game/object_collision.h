@@ -1,6 +1,18 @@
 #ifndef OBJECT_COLLISION_H
 #define OBJECT_COLLISION_H
 
+#include <PR/ultratypes.h>
+
+#ifdef OBJ_COLLISION_VERIFY
+// Frames where skipping pairs by their hitbox bounds changed the collision results, out of all frames checked
+struct ObjCollisionVerifyStats {
+    u32 frames;
+    u32 mismatches;
+};
+
+extern struct ObjCollisionVerifyStats gObjCollisionVerify;
+#endif
+
 void detect_object_collisions(void);
 
 #endif // OBJECT_COLLISION_H
@@ -165,6 +165,124 @@ Gfx *geo_switch_anim_state(s32 callContext, struct GraphNode *node)
     return NULL;
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * The area switch in levels with rooms has a case for each room, holding the display lists that are drawn while
+ * Mario is in it. Every case includes its own room's geometry, so a room can only be seen from the current one if
+ * their cases share a display list. That gives a room-to-room visibility table, built once per switch node, and
+ * objects tagged with a room the current case can't see are skipped when rendering.
+ */
+#define ROOM_CASES_MAX 64
+#define ROOM_DISPLAY_LISTS_MAX 512
+
+struct RoomDisplayList {
+    void *displayList;
+    u64 cases; // The cases that draw this display list
+};
+
+static struct GraphNodeSwitchCase *sRoomSwitch;
+static u64 sRoomVisibility[ROOM_CASES_MAX];
+static s16 sRoomCaseCount;
+static s16 sVisibleRoomCase;
+static u16 sVisibleRoomFrame;
+struct RoomVisibilityStats gRoomVisibilityStats;
+
+static s32 room_collect_display_lists(struct GraphNode *node, u64 caseBit, struct RoomDisplayList *lists,
+                                      s32 *count) {
+    struct GraphNode *cur = node;
+    s32 i;
+
+    do {
+        if (cur->type == GRAPH_NODE_TYPE_DISPLAY_LIST) {
+            void *displayList = ((struct GraphNodeDisplayList *) cur)->displayList;
+
+            for (i = 0; i < *count && lists[i].displayList != displayList; i++) {
+            }
+            if (i == *count) {
+                if (*count == ROOM_DISPLAY_LISTS_MAX) {
+                    return FALSE;
+                }
+                lists[i].displayList = displayList;
+                lists[i].cases = 0;
+                (*count)++;
+            }
+            lists[i].cases |= caseBit;
+        }
+        if (cur->children != NULL && !room_collect_display_lists(cur->children, caseBit, lists, count)) {
+            return FALSE;
+        }
+    } while ((cur = cur->next) != node);
+
+    return TRUE;
+}
+
+static void room_visibility_build(struct GraphNodeSwitchCase *switchCase) {
+    static struct RoomDisplayList lists[ROOM_DISPLAY_LISTS_MAX];
+    struct GraphNode *child = switchCase->fnNode.node.children;
+    s32 count = 0;
+    s32 valid = (child != NULL);
+    u64 drawn = 0;
+    s32 i;
+    s32 j;
+
+    sRoomSwitch = switchCase;
+    sRoomCaseCount = 0;
+
+    // Find which cases draw each display list
+    if (valid) {
+        do {
+            if (sRoomCaseCount == ROOM_CASES_MAX) {
+                valid = FALSE;
+                break;
+            }
+            sRoomVisibility[sRoomCaseCount] = (u64) 1 << sRoomCaseCount;
+            if (child->children != NULL
+                && !room_collect_display_lists(child->children, (u64) 1 << sRoomCaseCount, lists, &count)) {
+                valid = FALSE;
+                break;
+            }
+            sRoomCaseCount++;
+        } while ((child = child->next) != switchCase->fnNode.node.children);
+    }
+
+    // Without a complete table, every room is treated as visible
+    if (!valid) {
+        sRoomCaseCount = 0;
+        return;
+    }
+
+    // Cases that share a display list can see each other's rooms
+    for (i = 0; i < count; i++) {
+        drawn |= lists[i].cases;
+        for (j = 0; j < sRoomCaseCount; j++) {
+            if (lists[i].cases & ((u64) 1 << j)) {
+                sRoomVisibility[j] |= lists[i].cases;
+            }
+        }
+    }
+
+    // A room without display lists of its own has nothing to go by, so it's visible from everywhere
+    for (j = 0; j < sRoomCaseCount; j++) {
+        sRoomVisibility[j] |= ~drawn;
+    }
+}
+
+s32 room_is_visible(s16 room) {
+    s32 visible;
+
+    // Rooms are only known while a room switch has picked a case this frame
+    if (sRoomCaseCount == 0 || sVisibleRoomFrame != gAreaUpdateCounter || room <= 0 || room > sRoomCaseCount) {
+        return TRUE;
+    }
+
+    visible = (sRoomVisibility[sVisibleRoomCase] >> (room - 1)) & 1;
+    if (!visible) {
+        gRoomVisibilityStats.hidden++;
+    }
+    return visible;
+}
+#endif
+
 //! @bug Same issue as geo_switch_anim_state.
 #ifdef AVOID_UB
 Gfx *geo_switch_area(s32 callContext, struct GraphNode *node, UNUSED void *context)
@@ -196,8 +314,19 @@ Gfx *geo_switch_area(s32 callContext, struct GraphNode *node)
                 }
             }
         }
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        if (sRoomSwitch != switchCase) {
+            room_visibility_build(switchCase);
+        }
+        sVisibleRoomCase = switchCase->selectedCase;
+        sVisibleRoomFrame = gAreaUpdateCounter;
+#endif
     } else {
         switchCase->selectedCase = 0;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        // The graph may have been rebuilt, so the table is remade the next time it's rendered
+        sRoomSwitch = NULL;
+#endif
     }
 
     return NULL;
@@ -280,7 +409,11 @@ void obj_set_held_state(struct Object *obj, const BehaviorScript *heldBehavior)
             obj->oHeldState = HELD_DROPPED;
         }
     } else {
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        obj->curBhvCommand = bhv_script_decode(segmented_to_virtual(heldBehavior));
+#else
         obj->curBhvCommand = segmented_to_virtual(heldBehavior);
+#endif
         obj->bhvStackIndex = 0;
     }
 }
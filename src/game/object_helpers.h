@@ -72,6 +72,16 @@ Gfx *geo_switch_area(s32 callContext, struct GraphNode *node, UNUSED void *conte
 Gfx *geo_switch_anim_state(s32 callContext, struct GraphNode *node);
 Gfx *geo_switch_area(s32 callContext, struct GraphNode *node);
 #endif
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// How many roomed objects weren't drawn because their room can't be seen from the current one
+struct RoomVisibilityStats {
+    u32 hidden;
+};
+
+extern struct RoomVisibilityStats gRoomVisibilityStats;
+
+s32 room_is_visible(s16 room);
+#endif
 void obj_update_pos_from_parent_transformation(Mat4 a0, struct Object *a1);
 void obj_apply_scale_to_matrix(struct Object *obj, Mat4 dst, Mat4 src);
 void create_transformation_from_matrices(Mat4 a0, Mat4 a1, Mat4 a2);
@@ -107,7 +107,11 @@ struct Object *gCurrentObject;
 /**
  * The next object behavior command to be executed.
  */
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+const struct BhvCommand *gCurBhvCommand;
+#else
 const BehaviorScript *gCurBhvCommand;
+#endif
 
 /**
  * The number of objects that were processed last frame, which may miss some
@@ -117,6 +121,13 @@ const BehaviorScript *gCurBhvCommand;
  */
 s16 gPrevFrameObjectCount;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * Cycle counts from the last update_objects call, measured from its start.
+ */
+s64 gObjectUpdateCycles[8];
+#endif
+
 /**
  * The total number of surface nodes allocated (a node is allocated for each
  * spatial partition cell that a surface intersects).
@@ -625,6 +636,9 @@ UNUSED static u16 unused_get_elapsed_time(u64 *cycleCounts, s32 index) {
  */
 void update_objects(UNUSED s32 unused) {
     s64 cycleCounts[30];
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    s32 i;
+#endif
 
     cycleCounts[0] = get_current_clock();
 
@@ -671,6 +685,13 @@ void update_objects(UNUSED s32 unused) {
 
     cycleCounts[7] = get_clock_difference(cycleCounts[0]);
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // Keep the cycle counts around so the profiler can show them
+    for (i = 1; i < 8; i++) {
+        gObjectUpdateCycles[i] = cycleCounts[i];
+    }
+#endif
+
     cycleCounts[0] = 0;
     try_print_debug_mario_object_info();
 
@@ -87,8 +87,15 @@ extern struct Object *gMarioObject;
 extern struct Object *gLuigiObject;
 extern struct Object *gCurrentObject;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+extern const struct BhvCommand *gCurBhvCommand;
+#else
 extern const BehaviorScript *gCurBhvCommand;
+#endif
 extern s16 gPrevFrameObjectCount;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+extern s64 gObjectUpdateCycles[8];
+#endif
 
 extern s32 gSurfaceNodesAllocated;
 extern s32 gSurfacesAllocated;
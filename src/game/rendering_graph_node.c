@@ -1,4 +1,5 @@
 #include <PR/ultratypes.h>
+#include <math.h>
 
 #include "area.h"
 #include "engine/math_util.h"
@@ -6,6 +7,8 @@
 #include "gfx_dimensions.h"
 #include "main.h"
 #include "memory.h"
+#include "object_fields.h"
+#include "object_helpers.h"
 #include "print.h"
 #include "rendering_graph_node.h"
 #include "shadow.h"
@@ -40,6 +43,22 @@ s16 gMatStackIndex;
 Mat4 gMatStack[32];
 Mtx *gMatStackFixed[32];
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+s16 gLodDistanceScale = 16;
+f32 gObjCullDistance = 20000.0f;
+
+/**
+ * The slopes of the frustum's side planes, and how much a bounding sphere's radius widens them, which only
+ * change with the camera's fov, so they're set up once per perspective node instead of per object.
+ */
+struct FrustumSlopes {
+    f32 hTan, vTan;
+    f32 hSec, vSec;
+};
+
+static struct FrustumSlopes sFrustumSlopes;
+#endif
+
 /**
  * Animation nodes have state in global variables, so this struct captures
  * the animation state so a 'context switch' can be made when rendering the
@@ -67,6 +86,31 @@ s16 *gCurrAnimData;
 
 struct AllocOnlyPool *gDisplayListHeap;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * Objects that share an animation and frame, like a group of Goombas, pose their limbs the same way, so each
+ * limb's local transform is cached by its animation attributes and frame instead of being decoded per object.
+ * The cache is a fixed table, and a pose that hashes to a taken slot replaces it.
+ */
+#define POSE_CACHE_SIZE 256 // Must be a power of 2; each entry is 72 bytes
+
+struct PoseCacheEntry {
+    u16 *attribute; // The limb's first animation attribute, which identifies both the animation and the limb
+    s16 *data;
+    struct GraphNodeAnimatedPart *node;
+    f32 translationMultiplier;
+    s16 frame;
+    u16 generation; // 0 while the entry is unused or being filled
+    u8 type;
+    f32 matrix[4][3]; // Rotation rows, then the translation, like the DS m4x3 layout
+};
+
+static struct PoseCacheEntry sPoseCache[POSE_CACHE_SIZE];
+static struct PoseCacheEntry *sPoseCacheMiss;
+static u16 sPoseCacheGeneration = 1;
+struct PoseCacheStats gPoseCacheStats;
+#endif
+
 struct RenderModeContainer {
     u32 modes[8];
 };
@@ -169,6 +213,21 @@ static void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
     }
 }
 
+/**
+ * Return the fixed point version of the current matrix, converting it on first use. Nodes
+ * that only pass their transform on to children never draw with it, so they don't pay for
+ * the conversion or the display list allocation.
+ */
+static Mtx *get_mat_stack_fixed(void) {
+    if (gMatStackFixed[gMatStackIndex] == NULL) {
+        Mtx *mtx = alloc_display_list(sizeof(*mtx));
+
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+        gMatStackFixed[gMatStackIndex] = mtx;
+    }
+    return gMatStackFixed[gMatStackIndex];
+}
+
 /**
  * Appends the display list to one of the master lists based on the layer
  * parameter. Look at the RenderModeContainer struct to see the corresponding
@@ -183,7 +242,7 @@ static void geo_append_display_list(void *displayList, s16 layer) {
         struct DisplayListNode *listNode =
             alloc_only_pool_alloc(gDisplayListHeap, sizeof(struct DisplayListNode));
 
-        listNode->transform = gMatStackFixed[gMatStackIndex];
+        listNode->transform = get_mat_stack_fixed();
         listNode->displayList = displayList;
         listNode->next = 0;
         if (gCurGraphNodeMasterList->listHeads[layer] == 0) {
@@ -254,6 +313,17 @@ static void geo_process_perspective(struct GraphNodePerspective *node) {
 
         gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(mtx), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        {
+            // Use the same fov, widened by a degree, that obj_is_in_view always has
+            s16 halfFov = (node->fov / 2.0f + 1.0f) * 32768.0f / 180.0f + 0.5f;
+
+            sFrustumSlopes.vTan = sins(halfFov) / coss(halfFov);
+            sFrustumSlopes.hTan = sFrustumSlopes.vTan * (f32) gCurGraphNodeRoot->width / (f32) gCurGraphNodeRoot->height;
+            sFrustumSlopes.vSec = sqrtf(1.0f + sFrustumSlopes.vTan * sFrustumSlopes.vTan);
+            sFrustumSlopes.hSec = sqrtf(1.0f + sFrustumSlopes.hTan * sFrustumSlopes.hTan);
+        }
+#endif
         gCurGraphNodeCamFrustum = node;
         geo_process_node_and_siblings(node->fnNode.node.children);
         gCurGraphNodeCamFrustum = NULL;
@@ -267,9 +337,12 @@ static void geo_process_perspective(struct GraphNodePerspective *node) {
  * range of this node.
  */
 static void geo_process_level_of_detail(struct GraphNodeLevelOfDetail *node) {
-#ifdef GBI_FLOATS
+#if defined(GBI_FLOATS)
     Mtx *mtx = gMatStackFixed[gMatStackIndex];
     s16 distanceFromCam = (s32) -mtx->m[3][2]; // z-component of the translation column
+#elif defined(GBI_NATIVE_MTX)
+    // Read the float matrix, since the fixed point one may not have been converted
+    s16 distanceFromCam = (s32) -gMatStack[gMatStackIndex][3][2]; // z-component of the translation column
 #else
     // The fixed point Mtx type is defined as 16 longs, but it's actually 16
     // shorts for the integer parts followed by 16 shorts for the fraction parts
@@ -277,6 +350,14 @@ static void geo_process_level_of_detail(struct GraphNodeLevelOfDetail *node) {
     s16 distanceFromCam = -GET_HIGH_S16_OF_32(mtx->m[1][3]); // z-component of the translation column
 #endif
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // Switch to lower detail models sooner when the geometry budget is tight
+    if (gLodDistanceScale != 16) {
+        const s32 scaled = (s32) distanceFromCam * gLodDistanceScale / 16;
+        distanceFromCam = (scaled > 0x7FFF) ? 0x7FFF : scaled;
+    }
+#endif
+
     if (node->minDistance <= distanceFromCam && distanceFromCam < node->maxDistance) {
         if (node->node.children != 0) {
             geo_process_node_and_siblings(node->node.children);
@@ -310,7 +391,6 @@ static void geo_process_switch(struct GraphNodeSwitchCase *node) {
 static void geo_process_camera(struct GraphNodeCamera *node) {
     Mat4 cameraTransform;
     Mtx *rollMtx = alloc_display_list(sizeof(*rollMtx));
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     if (node->fnNode.func != NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
@@ -322,8 +402,7 @@ static void geo_process_camera(struct GraphNodeCamera *node) {
     mtxf_lookat(cameraTransform, node->pos, node->focus, node->roll);
     mtxf_mul(gMatStack[gMatStackIndex + 1], cameraTransform, gMatStack[gMatStackIndex]);
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->fnNode.node.children != 0) {
         gCurGraphNodeCamera = node;
         node->matrixPtr = &gMatStack[gMatStackIndex];
@@ -342,14 +421,12 @@ static void geo_process_camera(struct GraphNodeCamera *node) {
 static void geo_process_translation_rotation(struct GraphNodeTranslationRotation *node) {
     Mat4 mtxf;
     Vec3f translation;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     vec3s_to_vec3f(translation, node->translation);
     mtxf_rotate_zxy_and_translate(mtxf, translation, node->rotation);
     mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
     }
@@ -367,14 +444,12 @@ static void geo_process_translation_rotation(struct GraphNodeTranslationRotation
 static void geo_process_translation(struct GraphNodeTranslation *node) {
     Mat4 mtxf;
     Vec3f translation;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     vec3s_to_vec3f(translation, node->translation);
     mtxf_rotate_zxy_and_translate(mtxf, translation, gVec3sZero);
     mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
     }
@@ -391,13 +466,11 @@ static void geo_process_translation(struct GraphNodeTranslation *node) {
  */
 static void geo_process_rotation(struct GraphNodeRotation *node) {
     Mat4 mtxf;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     mtxf_rotate_zxy_and_translate(mtxf, gVec3fZero, node->rotation);
     mtxf_mul(gMatStack[gMatStackIndex + 1], mtxf, gMatStack[gMatStackIndex]);
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
     }
@@ -415,13 +488,11 @@ static void geo_process_rotation(struct GraphNodeRotation *node) {
 static void geo_process_scale(struct GraphNodeScale *node) {
     UNUSED Mat4 transform;
     Vec3f scaleVec;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     vec3f_set(scaleVec, node->scale, node->scale, node->scale);
     mtxf_scale_vec3f(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], scaleVec);
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
     }
@@ -439,7 +510,6 @@ static void geo_process_scale(struct GraphNodeScale *node) {
  */
 static void geo_process_billboard(struct GraphNodeBillboard *node) {
     Vec3f translation;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
     gMatStackIndex++;
     vec3s_to_vec3f(translation, node->translation);
@@ -453,8 +523,7 @@ static void geo_process_billboard(struct GraphNodeBillboard *node) {
                          gCurGraphNodeObject->scale);
     }
 
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = mtx;
+    gMatStackFixed[gMatStackIndex] = NULL;
 
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
@@ -537,6 +606,85 @@ static void geo_process_background(struct GraphNodeBackground *node) {
     }
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * Animations loaded into a shared buffer, like Mario's, reuse the same addresses,
+ * so every cached pose is dropped when one is replaced.
+ */
+void pose_cache_invalidate(void) {
+    s32 i;
+
+    if (++sPoseCacheGeneration == 0) {
+        for (i = 0; i < POSE_CACHE_SIZE; i++) {
+            sPoseCache[i].generation = 0;
+        }
+        sPoseCacheGeneration = 1;
+    }
+}
+
+/**
+ * Look up the local transform of the animated part about to be drawn. On a hit, the animation
+ * state is advanced past the limb as if it had been decoded. On a miss, the entry is claimed
+ * for pose_cache_store.
+ */
+static s32 pose_cache_load(struct GraphNodeAnimatedPart *node, Mat4 dest) {
+    struct PoseCacheEntry *pose;
+    s32 i;
+
+    sPoseCacheMiss = NULL;
+    if (gCurrAnimType == ANIM_TYPE_NONE) {
+        return FALSE;
+    }
+
+    pose = &sPoseCache[(((uintptr_t) gCurrAnimAttribute >> 2) ^ (gCurrAnimFrame * 37)) & (POSE_CACHE_SIZE - 1)];
+    if (pose->generation != sPoseCacheGeneration || pose->attribute != gCurrAnimAttribute
+        || pose->data != gCurrAnimData || pose->frame != gCurrAnimFrame || pose->node != node || pose->type != gCurrAnimType
+        || pose->translationMultiplier != gCurrAnimTranslationMultiplier) {
+        pose->attribute = gCurrAnimAttribute;
+        pose->data = gCurrAnimData;
+        pose->node = node;
+        pose->translationMultiplier = gCurrAnimTranslationMultiplier;
+        pose->frame = gCurrAnimFrame;
+        pose->generation = 0;
+        pose->type = gCurrAnimType;
+        sPoseCacheMiss = pose;
+        gPoseCacheStats.misses++;
+        return FALSE;
+    }
+
+    // Every limb reads 3 rotation attributes, and the first one 3 translation attributes before them
+    gCurrAnimAttribute += (gCurrAnimType == ANIM_TYPE_ROTATION) ? 3 * 2 : 6 * 2;
+    gCurrAnimType = ANIM_TYPE_ROTATION;
+
+    for (i = 0; i < 4; i++) {
+        dest[i][0] = pose->matrix[i][0];
+        dest[i][1] = pose->matrix[i][1];
+        dest[i][2] = pose->matrix[i][2];
+        dest[i][3] = 0;
+    }
+    dest[3][3] = 1;
+    gPoseCacheStats.hits++;
+    return TRUE;
+}
+
+/**
+ * Fill the entry claimed by the last miss with the decoded local transform.
+ */
+static void pose_cache_store(Mat4 src) {
+    struct PoseCacheEntry *pose = sPoseCacheMiss;
+    s32 i;
+
+    if (pose != NULL) {
+        for (i = 0; i < 4; i++) {
+            pose->matrix[i][0] = src[i][0];
+            pose->matrix[i][1] = src[i][1];
+            pose->matrix[i][2] = src[i][2];
+        }
+        pose->generation = sPoseCacheGeneration;
+    }
+}
+#endif
+
 /**
  * Render an animated part. The current animation state is not part of the node
  * but set in global variables. If an animated part is skipped, everything afterwards desyncs.
@@ -545,53 +693,59 @@ static void geo_process_animated_part(struct GraphNodeAnimatedPart *node) {
     Mat4 matrix;
     Vec3s rotation;
     Vec3f translation;
-    Mtx *matrixPtr = alloc_display_list(sizeof(*matrixPtr));
-
-    vec3s_copy(rotation, gVec3sZero);
-    vec3f_set(translation, node->translation[0], node->translation[1], node->translation[2]);
-    if (gCurrAnimType == ANIM_TYPE_TRANSLATION) {
-        translation[0] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[1] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        translation[2] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                          * gCurrAnimTranslationMultiplier;
-        gCurrAnimType = ANIM_TYPE_ROTATION;
-    } else {
-        if (gCurrAnimType == ANIM_TYPE_LATERAL_TRANSLATION) {
-            translation[0] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
-            gCurrAnimAttribute += 2;
-            translation[2] +=
-                gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
-                * gCurrAnimTranslationMultiplier;
+
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    if (!pose_cache_load(node, matrix))
+#endif
+    {
+        vec3s_copy(rotation, gVec3sZero);
+        vec3f_set(translation, node->translation[0], node->translation[1], node->translation[2]);
+        if (gCurrAnimType == ANIM_TYPE_TRANSLATION) {
+            translation[0] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
+                              * gCurrAnimTranslationMultiplier;
+            translation[1] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
+                              * gCurrAnimTranslationMultiplier;
+            translation[2] += gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
+                              * gCurrAnimTranslationMultiplier;
             gCurrAnimType = ANIM_TYPE_ROTATION;
         } else {
-            if (gCurrAnimType == ANIM_TYPE_VERTICAL_TRANSLATION) {
-                gCurrAnimAttribute += 2;
-                translation[1] +=
+            if (gCurrAnimType == ANIM_TYPE_LATERAL_TRANSLATION) {
+                translation[0] +=
                     gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
                     * gCurrAnimTranslationMultiplier;
                 gCurrAnimAttribute += 2;
+                translation[2] +=
+                    gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
+                    * gCurrAnimTranslationMultiplier;
                 gCurrAnimType = ANIM_TYPE_ROTATION;
-            } else if (gCurrAnimType == ANIM_TYPE_NO_TRANSLATION) {
-                gCurrAnimAttribute += 6;
-                gCurrAnimType = ANIM_TYPE_ROTATION;
+            } else {
+                if (gCurrAnimType == ANIM_TYPE_VERTICAL_TRANSLATION) {
+                    gCurrAnimAttribute += 2;
+                    translation[1] +=
+                        gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)]
+                        * gCurrAnimTranslationMultiplier;
+                    gCurrAnimAttribute += 2;
+                    gCurrAnimType = ANIM_TYPE_ROTATION;
+                } else if (gCurrAnimType == ANIM_TYPE_NO_TRANSLATION) {
+                    gCurrAnimAttribute += 6;
+                    gCurrAnimType = ANIM_TYPE_ROTATION;
+                }
             }
         }
-    }
 
-    if (gCurrAnimType == ANIM_TYPE_ROTATION) {
-        rotation[0] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[1] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
-        rotation[2] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+        if (gCurrAnimType == ANIM_TYPE_ROTATION) {
+            rotation[0] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+            rotation[1] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+            rotation[2] = gCurrAnimData[retrieve_animation_index(gCurrAnimFrame, &gCurrAnimAttribute)];
+        }
+        mtxf_rotate_xyz_and_translate(matrix, translation, rotation);
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        pose_cache_store(matrix);
+#endif
     }
-    mtxf_rotate_xyz_and_translate(matrix, translation, rotation);
     mtxf_mul(gMatStack[gMatStackIndex + 1], matrix, gMatStack[gMatStackIndex]);
     gMatStackIndex++;
-    mtxf_to_mtx(matrixPtr, gMatStack[gMatStackIndex]);
-    gMatStackFixed[gMatStackIndex] = matrixPtr;
+    gMatStackFixed[gMatStackIndex] = NULL;
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, node->node.flags >> 8);
     }
@@ -746,9 +900,13 @@ static void geo_process_shadow(struct GraphNodeShadow *node) {
  */
 static s32 obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
     s16 cullingRadius;
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
     s16 halfFov; // half of the fov in in-game angle units instead of degrees
+#endif
     struct GraphNode *geo;
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
     f32 hScreenEdge;
+#endif
 
     if (node->node.flags & GRAPH_RENDER_INVISIBLE) {
         return FALSE;
@@ -756,6 +914,7 @@ static s32 obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
 
     geo = node->sharedChild;
 
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
     // ! @bug The aspect ratio is not accounted for. When the fov value is 45,
     // the horizontal effective fov is actually 60 degrees, so you can see objects
     // visibly pop in or out at the edge of the screen.
@@ -770,6 +929,7 @@ static s32 obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
     // This multiplication should really be performed on 4:3 as well,
     // but the issue will be more apparent on widescreen.
     hScreenEdge *= GFX_DIMENSIONS_ASPECT_RATIO;
+#endif
 #endif
 
     if (geo != NULL && geo->type == GRAPH_NODE_TYPE_CULLING_RADIUS) {
@@ -788,10 +948,31 @@ static s32 obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
     //  makes PU travel safe when the camera is locked on the main map.
     //  If Mario were rendered with a depth over 65536 it would cause overflow
     //  when converting the transformation matrix to a fixed point matrix.
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // The renderer pulls this in when the geometry budget is tight
+    if (matrix[3][2] < -gObjCullDistance - cullingRadius) {
+#else
     if (matrix[3][2] < -20000.0f - cullingRadius) {
+#endif
         return FALSE;
     }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // Test the bounding sphere against all four side planes of the frustum. The fov is vertical, so the
+    // horizontal edge is scaled by the aspect ratio, and the radius is scaled by the secant of each half angle
+    // so it's measured along the plane's normal instead of sideways.
+    {
+        f32 vEdge = -matrix[3][2] * sFrustumSlopes.vTan + cullingRadius * sFrustumSlopes.vSec;
+        f32 hEdge = -matrix[3][2] * sFrustumSlopes.hTan + cullingRadius * sFrustumSlopes.hSec;
+
+        if (matrix[3][0] > hEdge || matrix[3][0] < -hEdge) {
+            return FALSE;
+        }
+        if (matrix[3][1] > vEdge || matrix[3][1] < -vEdge) {
+            return FALSE;
+        }
+    }
+#else
     // Check whether the object is horizontally in view
     if (matrix[3][0] > hScreenEdge + cullingRadius) {
         return FALSE;
@@ -799,6 +980,7 @@ static s32 obj_is_in_view(struct GraphNodeObject *node, Mat4 matrix) {
     if (matrix[3][0] < -hScreenEdge - cullingRadius) {
         return FALSE;
     }
+#endif
     return TRUE;
 }
 
@@ -832,11 +1014,13 @@ static void geo_process_object(struct Object *node) {
         if (node->header.gfx.animInfo.curAnim != NULL) {
             geo_set_animation_globals(&node->header.gfx.animInfo, hasAnimation);
         }
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        // Objects in rooms that can't be seen from the current one are behind walls
+        if (obj_is_in_view(&node->header.gfx, gMatStack[gMatStackIndex]) && room_is_visible(node->oRoom)) {
+#else
         if (obj_is_in_view(&node->header.gfx, gMatStack[gMatStackIndex])) {
-            Mtx *mtx = alloc_display_list(sizeof(*mtx));
-
-            mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-            gMatStackFixed[gMatStackIndex] = mtx;
+#endif
+            gMatStackFixed[gMatStackIndex] = NULL;
             if (node->header.gfx.sharedChild != NULL) {
                 gCurGraphNodeObject = (struct GraphNodeObject *) node;
                 node->header.gfx.sharedChild->parent = &node->header.gfx.node;
@@ -877,7 +1061,6 @@ static void geo_process_object_parent(struct GraphNodeObjectParent *node) {
 void geo_process_held_object(struct GraphNodeHeldObject *node) {
     Mat4 mat;
     Vec3f translation;
-    Mtx *mtx = alloc_display_list(sizeof(*mtx));
 
 #ifdef F3DEX_GBI_2
     gSPLookAt(gDisplayListHead++, &lookAt);
@@ -906,8 +1089,7 @@ void geo_process_held_object(struct GraphNodeHeldObject *node) {
                               (struct AllocOnlyPool *) gMatStack[gMatStackIndex + 1]);
         }
         gMatStackIndex++;
-        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
-        gMatStackFixed[gMatStackIndex] = mtx;
+        gMatStackFixed[gMatStackIndex] = NULL;
         gGeoTempState.type = gCurrAnimType;
         gGeoTempState.enabled = gCurrAnimEnabled;
         gGeoTempState.frame = gCurrAnimFrame;
@@ -13,6 +13,22 @@ extern struct GraphNodeObject *gCurGraphNodeObject;
 extern struct GraphNodeHeldObject *gCurGraphNodeHeldObject;
 extern u16 gAreaUpdateCounter;
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// Set by the renderer when the scene gets close to the DS polygon and vertex limits
+extern s16 gLodDistanceScale; // Distances used for level of detail are multiplied by this / 16
+extern f32 gObjCullDistance;  // Objects further away than this aren't drawn
+
+// How often animated limbs found their local transform already posed by another object
+struct PoseCacheStats {
+    u32 hits;
+    u32 misses;
+};
+
+extern struct PoseCacheStats gPoseCacheStats;
+
+void pose_cache_invalidate(void);
+#endif
+
 // after processing an object, the type is reset to this
 #define ANIM_TYPE_NONE                  0
 
@@ -8,6 +8,7 @@
 #include "memory.h"
 #include "save_file.h"
 #include "segment2.h"
+#include "skybox.h"
 #include "sm64.h"
 
 
@@ -60,6 +61,14 @@ struct Skybox {
 
 struct Skybox sSkyBoxInfo[2];
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * The level's skybox image, converted for the DS background layer, is streamed into this segment.
+ */
+#define SKYBOX_SEGMENT 0x0A
+
+struct SkyboxLayer gSkyboxLayer;
+#else
 typedef const u8 *const SkyboxTexture[80];
 
 extern SkyboxTexture bbh_skybox_ptrlist;
@@ -85,6 +94,7 @@ SkyboxTexture *sSkyboxTextures[10] = {
     &clouds_skybox_ptrlist,
     &bits_skybox_ptrlist,
 };
+#endif
 
 /**
  * The skybox color mask.
@@ -124,6 +134,11 @@ u8 sSkyboxColors[][3] = {
  */
 #define SKYBOX_ROWS (8)
 
+/**
+ * The width and height of the skybox image on the DS background layer, in texels.
+ */
+#define SKYBOX_LAYER_SIZE (256)
+
 
 /**
  * Convert the camera's yaw into an x position into the scaled skybox image.
@@ -186,6 +201,7 @@ static s32 get_top_left_tile_idx(s8 player) {
     return tileRow * SKYBOX_COLS + tileCol;
 }
 
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
 /**
  * Generates vertices for the skybox tile.
  *
@@ -282,6 +298,35 @@ Gfx *init_skybox_display_list(s8 player, s8 background, s8 colorIndex) {
     }
     return skybox;
 }
+#else
+/**
+ * Points the DS background layer at the part of the skybox that the 3x3 grid of tiles would cover.
+ * The image is stretched to a square at build time, so the full 360 degrees wrap around the layer.
+ *
+ * The image is whichever one the level loaded into the skybox segment, like the N64 tile pointers were.
+ *
+ * Returns an empty display list, since the background node draws a fill color instead when given NULL.
+ */
+Gfx *init_skybox_layer(s8 player, UNUSED s8 background, s8 colorIndex) {
+    Gfx *dlist = alloc_display_list(sizeof(Gfx));
+
+    if (dlist == NULL) {
+        return NULL;
+    }
+
+    gSkyboxLayer.image = get_segment_base_addr(SKYBOX_SEGMENT);
+    gSkyboxLayer.x = sSkyBoxInfo[player].scaledX * (SKYBOX_LAYER_SIZE << 8) / SKYBOX_WIDTH;
+    gSkyboxLayer.y = (SKYBOX_HEIGHT - sSkyBoxInfo[player].scaledY) * (SKYBOX_LAYER_SIZE << 8) / SKYBOX_HEIGHT;
+    gSkyboxLayer.width = SCREEN_WIDTH * (SKYBOX_LAYER_SIZE << 8) / SKYBOX_WIDTH;
+    gSkyboxLayer.height = SCREEN_HEIGHT * (SKYBOX_LAYER_SIZE << 8) / SKYBOX_HEIGHT;
+    gSkyboxLayer.color[0] = sSkyboxColors[colorIndex][0];
+    gSkyboxLayer.color[1] = sSkyboxColors[colorIndex][1];
+    gSkyboxLayer.color[2] = sSkyboxColors[colorIndex][2];
+
+    gSPEndDisplayList(dlist);
+    return dlist;
+}
+#endif
 
 /**
  * Draw a skybox facing the direction from pos to foc.
@@ -317,5 +362,9 @@ Gfx *create_skybox_facing_camera(s8 player, s8 background, f32 fov,
     sSkyBoxInfo[player].scaledY = calculate_skybox_scaled_y(player, fov);
     sSkyBoxInfo[player].upperLeftTile = get_top_left_tile_idx(player);
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    return init_skybox_layer(player, background, colorIndex);
+#else
     return init_skybox_display_list(player, background, colorIndex);
+#endif
 }
@@ -8,4 +8,18 @@ Gfx *create_skybox_facing_camera(s8 player, s8 background, f32 fov,
                                  f32 posX, f32 posY, f32 posZ,
                                  f32 focX, f32 focY, f32 focZ);
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+// The DS draws the skybox on a 2D background layer behind the 3D one, instead of as a grid of quads
+// This is set up while the frame is built, and read by the renderer when it draws the frame
+struct SkyboxLayer {
+    const u8 *image; // Converted by skyconv, or NULL if there's no skybox this frame
+    s32 x, y;        // Texel at the top left of the screen, with 8 fractional bits
+    s32 width;       // Texels across and down the screen, with 8 fractional bits
+    s32 height;
+    u8 color[3];
+};
+
+extern struct SkyboxLayer gSkyboxLayer;
+#endif
+
 #endif // SKYBOX_H
@@ -1,6 +1,7 @@
 #include <PR/ultratypes.h>
 
 #include "audio/external.h"
+#include "engine/behavior_script.h"
 #include "engine/geo_layout.h"
 #include "engine/graph_node.h"
 #include "engine/math_util.h"
@@ -327,7 +328,12 @@ struct Object *create_object(const BehaviorScript *bhvScript) {
     objList = &gObjectLists[objListIndex];
     obj = allocate_object(objList);
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    // Scripts are decoded the first time an object running them spawns
+    obj->curBhvCommand = bhv_script_decode(bhvScript);
+#else
     obj->curBhvCommand = bhvScript;
+#endif
     obj->behavior = behavior;
 
     if (objListIndex == OBJ_LIST_UNIMPORTANT) {
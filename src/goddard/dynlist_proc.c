@@ -32,6 +32,10 @@
 #define DYNOBJ_LIST_SIZE 3000
 /// Maximum number of verticies supported when adding vertices node to an `ObjShape`
 #define VTX_BUF_SIZE 3000
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/// Number of slots in the dynamic object name index; a power of 2 well above `DYNOBJ_LIST_SIZE`
+#define DYNOBJ_INDEX_SIZE 4096
+#endif
 
 // types
 /// Information about a dynamically created `GdObj`
@@ -84,6 +88,12 @@ static struct GdObj *sStashedDynObj;          // @ 801B9F3C
 static s32 sDynNetCount;                      // @ 801B9F40
 static char sDynNetNameSuffix[0x20];               // @ 801B9F48
 static char sStashedDynNameSuffix[0x100];                  // @ 801B9F68
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/// Open-addressed index of `sGdDynObjList` by name. Each slot holds a list index + 1, or 0 if empty.
+/// Almost every dynlist command looks an object up by name, which made building Mario's head quadratic.
+static u16 sDynObjIndex[DYNOBJ_INDEX_SIZE];
+struct DynObjLookupStats gDynObjLookupStats;
+#endif
 
 // necessary foreward declarations
 void d_add_net_with_subgroup(s32, DynObjName);
@@ -392,6 +402,49 @@ static void unstash_name_suffix(void) {
     gd_strcpy(sDynNameSuffix, sStashedDynNameSuffix);
 }
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/**
+ * FNV-1a hash of an object name.
+ */
+static u32 dynobj_name_hash(const char *name) {
+    u32 hash = 2166136261u;
+
+    while (*name) {
+        hash = (hash ^ (u8) *name++) * 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Empty the name index, when the dynamic object list is started over.
+ */
+static void clear_dynobj_index(void) {
+    s32 i;
+
+    for (i = 0; i < DYNOBJ_INDEX_SIZE; i++) {
+        sDynObjIndex[i] = 0;
+    }
+}
+
+/**
+ * Add entry `num` of the dynamic object list to the name index.
+ */
+static void add_dynobj_index(s32 num) {
+    u32 slot = dynobj_name_hash(sGdDynObjList[num].name) & (DYNOBJ_INDEX_SIZE - 1);
+
+    while (sDynObjIndex[slot] != 0) {
+        // The list was searched front to back, so of objects with the same name, the first one is found
+        if (gd_str_not_equal(sGdDynObjList[sDynObjIndex[slot] - 1].name, sGdDynObjList[num].name) == 0) {
+            return;
+        }
+        slot = (slot + 1) & (DYNOBJ_INDEX_SIZE - 1);
+    }
+
+    sDynObjIndex[slot] = num + 1;
+}
+#endif
+
 /**
  * Get the `DynObjInfo` struct for object `name`
  *
@@ -401,7 +454,9 @@ static void unstash_name_suffix(void) {
 static struct DynObjInfo *get_dynobj_info(DynObjName name) {
     struct DynObjInfo *foundDynobj;
     char buf[0x100];
+#if !defined(TARGET_NDS) && !defined(TARGET_HOST)
     s32 i;
+#endif
 
     if (sLoadedDynObjs == 0) {
         return NULL;
@@ -415,12 +470,43 @@ static struct DynObjInfo *get_dynobj_info(DynObjName name) {
 
     gd_strcat(buf, sDynNameSuffix);
     foundDynobj = NULL;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    {
+        u32 slot = dynobj_name_hash(buf) & (DYNOBJ_INDEX_SIZE - 1);
+
+        gDynObjLookupStats.lookups++;
+        for (; sDynObjIndex[slot] != 0; slot = (slot + 1) & (DYNOBJ_INDEX_SIZE - 1)) {
+            gDynObjLookupStats.probes++;
+            if (gd_str_not_equal(sGdDynObjList[sDynObjIndex[slot] - 1].name, buf) == 0) {
+                foundDynobj = &sGdDynObjList[sDynObjIndex[slot] - 1];
+                break;
+            }
+        }
+    }
+#ifdef DYNOBJ_INDEX_VERIFY
+    {
+        struct DynObjInfo *scanned = NULL;
+        s32 i;
+
+        for (i = 0; i < sLoadedDynObjs; i++) {
+            if (gd_str_not_equal(sGdDynObjList[i].name, buf) == 0) {
+                scanned = &sGdDynObjList[i];
+                break;
+            }
+        }
+        if (scanned != foundDynobj) {
+            gDynObjLookupStats.mismatches++;
+        }
+    }
+#endif
+#else
     for (i = 0; i < sLoadedDynObjs; i++) {
         if (gd_str_not_equal(sGdDynObjList[i].name, buf) == 0) {
             foundDynobj = &sGdDynObjList[i];
             break;
         }
     }
+#endif
 
     return foundDynobj;
 }
@@ -540,6 +626,9 @@ void add_to_dynobj_list(struct GdObj *newobj, DynObjName name) {
         if (sGdDynObjList == NULL) {
             fatal_printf("dMakeObj(): Cant allocate dynlist memory");
         }
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+        clear_dynobj_index();
+#endif
     }
 
     stop_memtracker("dynlist");
@@ -569,6 +658,9 @@ void add_to_dynobj_list(struct GdObj *newobj, DynObjName name) {
     sGdDynObjList[sLoadedDynObjs].num = sLoadedDynObjs;
     sDynListCurInfo = &sGdDynObjList[sLoadedDynObjs];
     sGdDynObjList[sLoadedDynObjs++].obj = newobj;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    add_dynobj_index(sLoadedDynObjs - 1);
+#endif
 
     // A good place to bounds-check your array is
     // after you finish writing a new member to it.
@@ -56,6 +56,20 @@ enum DObjTypes {
     D_GROUP         = 18
 };
 
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+/// Name lookups in the dynamic object list, and the index slots they looked at
+struct DynObjLookupStats {
+    u32 lookups;
+    u32 probes;
+#ifdef DYNOBJ_INDEX_VERIFY
+    u32 mismatches; ///< lookups where the index and a linear scan found different objects
+#endif
+};
+
+// data
+extern struct DynObjLookupStats gDynObjLookupStats;
+#endif
+
 // functions
 void d_stash_dynobj(void);
 void d_unstash_dynobj(void);
@@ -8,12 +8,24 @@
 #include "macros.h"
 #include "renderer.h"
 
+#ifdef FIXED_POINT_GODDARD
+#include <math.h>
+#endif
+
 /**
  * Finds the square root of a float by treating
  * it as a double and finding the square root from there.
  */
 f32 gd_sqrt_f(f32 val) {
+#ifdef FIXED_POINT_GODDARD
+    // Skip the round trip through f64, which is twice the soft-float work on the DS
+    if (val < 1.0e-7f) {
+        return 0.0f;
+    }
+    return gd_fixed_sqrt_f(val);
+#else
     return (f32) gd_sqrt_d(val);
+#endif
 }
 
 /**
@@ -963,3 +975,156 @@ void UNUSED gd_rot_mat_offset(Mat4f *dst, f32 x, f32 y, f32 z, s32 copy) {
         gd_copy_mat4f(&rot, dst);
     }
 }
+
+#ifdef FIXED_POINT_GODDARD
+#ifdef TARGET_NDS
+// The ARM9 has a memory-mapped square root unit, which takes about 34 cycles for a 64-bit input.
+// Like the divider in surface_collision.c, it isn't used from interrupts.
+#define REG_SQRTCNT      (*(vu16 *) 0x040002B0)
+#define REG_SQRT_RESULT  (*(vu32 *) 0x040002B4)
+#define REG_SQRT_PARAM   (*(vu64 *) 0x040002B8)
+#define SQRT_64          1
+#define SQRT_BUSY        (1 << 15)
+
+static u32 gd_isqrt64(u64 val) {
+    REG_SQRTCNT = SQRT_64;
+    REG_SQRT_PARAM = val;
+    while (REG_SQRTCNT & SQRT_BUSY);
+    return REG_SQRT_RESULT;
+}
+#else
+static u32 gd_isqrt64(u64 val) {
+    u64 root = 0;
+    u64 bit = (u64) 1 << 62;
+
+    while (bit > val) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (val >= root + bit) {
+            val -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+#endif
+
+// Sines of a quarter turn, which gd_fixed_sin interpolates between
+#define FIXED_SINE_SEGMENTS 256
+#define FIXED_SINE_QUARTER  (GD_FIXED_TURN / 4)
+#define FIXED_SINE_STEP     (FIXED_SINE_QUARTER / FIXED_SINE_SEGMENTS)
+static s32 sFixedSineTable[FIXED_SINE_SEGMENTS + 1];
+
+/**
+ * Converts a vector to 20.12 fixed point.
+ */
+void gd_vec3f_to_fixed(struct GdFixedVec3 *dst, const struct GdVec3f *src) {
+    dst->x = (s32)(src->x * GD_FIXED_POS_ONE);
+    dst->y = (s32)(src->y * GD_FIXED_POS_ONE);
+    dst->z = (s32)(src->z * GD_FIXED_POS_ONE);
+}
+
+/**
+ * Converts the rotation of a mat4f to 16.16 fixed point, and its translation to 20.12.
+ */
+void gd_mat4f_to_fixed(GdFixedMat4x3 *dst, const Mat4f *src) {
+    s32 i;
+
+    for (i = 0; i < 3; i++) {
+        (*dst)[i][0] = (s32)((*src)[i][0] * GD_FIXED_ROT_ONE);
+        (*dst)[i][1] = (s32)((*src)[i][1] * GD_FIXED_ROT_ONE);
+        (*dst)[i][2] = (s32)((*src)[i][2] * GD_FIXED_ROT_ONE);
+    }
+    (*dst)[3][0] = (s32)((*src)[3][0] * GD_FIXED_POS_ONE);
+    (*dst)[3][1] = (s32)((*src)[3][1] * GD_FIXED_POS_ONE);
+    (*dst)[3][2] = (s32)((*src)[3][2] * GD_FIXED_POS_ONE);
+}
+
+/**
+ * Fixed-point version of gd_rotate_and_translate_vec3f.
+ */
+void gd_fixed_rotate_and_translate_vec3(struct GdFixedVec3 *vec, const GdFixedMat4x3 *mtx) {
+    struct GdFixedVec3 out;
+
+    out.x = (s32)(((s64)(*mtx)[0][0] * vec->x + (s64)(*mtx)[1][0] * vec->y + (s64)(*mtx)[2][0] * vec->z)
+                  >> GD_FIXED_ROT_SHIFT);
+    out.y = (s32)(((s64)(*mtx)[0][1] * vec->x + (s64)(*mtx)[1][1] * vec->y + (s64)(*mtx)[2][1] * vec->z)
+                  >> GD_FIXED_ROT_SHIFT);
+    out.z = (s32)(((s64)(*mtx)[0][2] * vec->x + (s64)(*mtx)[1][2] * vec->y + (s64)(*mtx)[2][2] * vec->z)
+                  >> GD_FIXED_ROT_SHIFT);
+
+    vec->x = out.x + (*mtx)[3][0];
+    vec->y = out.y + (*mtx)[3][1];
+    vec->z = out.z + (*mtx)[3][2];
+}
+
+/**
+ * Returns the sine of an angle in 1/(1 << 24) turns, in 2.30 fixed point. The quarter-wave table
+ * is built on first use, and interpolated to within about 5e-6.
+ */
+s32 gd_fixed_sin(u32 angle) {
+    u32 quadrant;
+    u32 index;
+    s32 frac;
+    s32 sine;
+    s32 i;
+
+    if (sFixedSineTable[FIXED_SINE_SEGMENTS] == 0) {
+        for (i = 0; i <= FIXED_SINE_SEGMENTS; i++) {
+            sFixedSineTable[i] =
+                (s32)(sinf(i * (RAD_PER_DEG * 90.0 / FIXED_SINE_SEGMENTS)) * (1 << GD_FIXED_SINE_SHIFT));
+        }
+    }
+
+    angle &= GD_FIXED_TURN - 1;
+    quadrant = angle / FIXED_SINE_QUARTER;
+    angle %= FIXED_SINE_QUARTER;
+    if (quadrant & 1) {
+        angle = FIXED_SINE_QUARTER - angle;
+    }
+
+    index = angle / FIXED_SINE_STEP;
+    if (index >= FIXED_SINE_SEGMENTS) {
+        sine = sFixedSineTable[FIXED_SINE_SEGMENTS];
+    } else {
+        frac = angle % FIXED_SINE_STEP;
+        sine = sFixedSineTable[index]
+               + (s32)((s64)(sFixedSineTable[index + 1] - sFixedSineTable[index]) * frac / FIXED_SINE_STEP);
+    }
+
+    return (quadrant & 2) ? -sine : sine;
+}
+
+/**
+ * Finds the square root of a positive float with an integer square root of its mantissa,
+ * truncated to within an ulp. Zero and denormals give 0.
+ */
+f32 gd_fixed_sqrt_f(f32 val) {
+    union {
+        f32 f;
+        u32 i;
+    } bits;
+    s32 exponent;
+    u64 mantissa;
+
+    bits.f = val;
+    exponent = (s32)((bits.i >> 23) & 0xFF) - 127;
+    if (exponent == -127 || (bits.i >> 31)) {
+        return 0.0f;
+    }
+
+    // Make the exponent even, so the mantissa is in [1, 4) and its root is in [1, 2)
+    mantissa = (bits.i & 0x7FFFFF) | 0x800000;
+    if (exponent & 1) {
+        mantissa <<= 1;
+        exponent--;
+    }
+
+    bits.i = ((u32)(exponent / 2 + 127) << 23) | (gd_isqrt64(mantissa << 23) & 0x7FFFFF);
+    return bits.f;
+}
+#endif
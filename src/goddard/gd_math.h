@@ -53,4 +53,25 @@ void gd_print_vec(UNUSED const char *prefix, const struct GdVec3f *vec);
 void gd_print_bounding_box(UNUSED const char *prefix, const struct GdBoundingBox *p);
 void gd_print_mtx(UNUSED const char *prefix, const Mat4f *mtx);
 
+#ifdef FIXED_POINT_GODDARD
+// Skinned positions and translations use 20.12 fixed point, and rotations and weights use 16.16.
+// Sines are 2.30, of angles in 1/(1 << 24) turns.
+#define GD_FIXED_POS_SHIFT   12
+#define GD_FIXED_POS_ONE     (1 << GD_FIXED_POS_SHIFT)
+#define GD_FIXED_ROT_SHIFT   16
+#define GD_FIXED_ROT_ONE     (1 << GD_FIXED_ROT_SHIFT)
+#define GD_FIXED_SINE_SHIFT  30
+#define GD_FIXED_TURN_SHIFT  24
+#define GD_FIXED_TURN        (1 << GD_FIXED_TURN_SHIFT)
+
+// The 3x3 rotation and the translation row of a Mat4f, as used by gd_rotate_and_translate_vec3f
+typedef s32 GdFixedMat4x3[4][3];
+
+void gd_vec3f_to_fixed(struct GdFixedVec3 *dst, const struct GdVec3f *src);
+void gd_mat4f_to_fixed(GdFixedMat4x3 *dst, const Mat4f *src);
+void gd_fixed_rotate_and_translate_vec3(struct GdFixedVec3 *vec, const GdFixedMat4x3 *mtx);
+s32 gd_fixed_sin(u32 angle);
+f32 gd_fixed_sqrt_f(f32 val);
+#endif
+
 #endif // GD_MATH_H
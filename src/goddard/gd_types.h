@@ -25,6 +25,13 @@ struct GdAnimTransform {
 
 typedef f32 Mat4f[4][4];
 
+#ifdef FIXED_POINT_GODDARD
+// Skinned positions in 20.12 fixed point (see gd_math.h)
+struct GdFixedVec3 {
+    s32 x, y, z;
+};
+#endif
+
 struct GdColour {
     f32 r, g, b;
 };
@@ -371,6 +378,10 @@ struct ObjVertex {
     /* 0x3C */ f32 scaleFactor;
     /* 0x40 */ f32 alpha;
     /* 0x44 */ struct VtxLink *gbiVerts;
+#ifdef FIXED_POINT_GODDARD
+    struct GdFixedVec3 fixedBase; // initPos scaled by scaleFactor, which skinning starts from
+    struct GdFixedVec3 fixedPos;  // pos while joints add their weights to it
+#endif
 }; /* sizeof = 0x48 */
 
 /**
@@ -448,6 +459,10 @@ struct ObjWeight {
     /* 0x2C */ u8  filler2[12];
     /* 0x38 */ f32 weightVal; // weight (unit?)
     /* 0x3C */ struct ObjVertex* vtx;
+#ifdef FIXED_POINT_GODDARD
+    struct GdFixedVec3 fixedVec20; // vec20 in 20.12
+    s32 fixedWeight;               // weightVal in 16.16
+#endif
 }; /* sizeof = 0x40 */
 
 /* This union is used in ObjGadget for a variable typed field.
@@ -195,6 +195,9 @@ static struct GdTimer *D_801A86A4 = NULL; // timer for dlgen, dynamics, or rcp
 static struct GdTimer *D_801A86A8 = NULL; // timer for dlgen, dynamics, or rcp
 static struct GdTimer *D_801A86AC = NULL; // timer for dlgen, dynamics, or rcp
 s32 gGdFrameBufNum = 0;                      // @ 801A86B0
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+OSTime gGdmSetupTime;
+#endif
 UNUSED static u32 unref_801a86B4 = 0;
 static struct ObjShape *sHandShape = NULL; // @ 801A86B8
 static s32 D_801A86BC = 1;
@@ -840,6 +843,26 @@ static Vp *next_vp(void) {
     return &sCurrentGdDl->vp[sCurrentGdDl->curVpIdx++];
 }
 
+#ifdef FIXED_POINT_GODDARD
+// Radians to the 1/(1 << 24) turns that gd_fixed_sin takes
+#define FIXED_TURNS_PER_RAD (GD_FIXED_TURN / 360.0 * DEG_PER_RAD)
+
+f64 gd_sin_d(f64 x) {
+    return gd_fixed_sin((u32)(s64)(x * FIXED_TURNS_PER_RAD)) * (1.0 / (1 << GD_FIXED_SINE_SHIFT));
+}
+
+f64 gd_cos_d(f64 x) {
+    return gd_fixed_sin((u32)(s64)(x * FIXED_TURNS_PER_RAD) + GD_FIXED_TURN / 4)
+           * (1.0 / (1 << GD_FIXED_SINE_SHIFT));
+}
+
+f64 gd_sqrt_d(f64 x) {
+    if (x < 1.0e-7) {
+        return 0.0;
+    }
+    return gd_fixed_sqrt_f(x);
+}
+#else
 /* 249AAC -> 249AEC */
 f64 gd_sin_d(f64 x) {
     return sinf(x);
@@ -857,6 +880,7 @@ f64 gd_sqrt_d(f64 x) {
     }
     return sqrtf(x);
 }
+#endif
 
 /**
  * Unused
@@ -1169,6 +1193,9 @@ void gdm_init(void *blockpool, u32 size) {
  */
 void gdm_setup(void) {
     UNUSED u8 filler[4];
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    OSTime start = osGetTime();
+#endif
 
     imin("gdm_setup");
     sYoshiSceneGrp = NULL;
@@ -1183,6 +1210,9 @@ void gdm_setup(void) {
     reset_cur_dl_indices();
     setup_stars();
     imout();
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+    gGdmSetupTime = osGetTime() - start;
+#endif
 }
 
 /* 24AC18 -> 24AC2C */
@@ -1711,7 +1741,7 @@ u32 Unknown8019EC88(Gfx *dl, UNUSED s32 arg1) {
 
 /* 24D4C4 -> 24D63C; orig name: func_8019ECF4 */
 void mat4_to_mtx(Mat4f *src, Mtx *dst) {
-#ifndef GBI_FLOATS
+#if !defined(GBI_FLOATS) && !defined(GBI_NATIVE_MTX)
     s32 i; // 14
     s32 j; // 10
     s32 w1;
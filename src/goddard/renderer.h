@@ -35,6 +35,9 @@ enum GdSceneId {
 
 // data
 extern s32 gGdFrameBufNum;
+#if defined(TARGET_NDS) || defined(TARGET_HOST)
+extern OSTime gGdmSetupTime; ///< How long the last `gdm_setup()` took, in `osGetTime()` ticks
+#endif
 
 // functions
 u32 get_alloc_mem_amt(void);
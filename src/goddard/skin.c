@@ -5,6 +5,7 @@
 #endif
 
 #include "debug_utils.h"
+#include "gd_macros.h"
 #include "gd_main.h"
 #include "gd_math.h"
 #include "gd_types.h"
@@ -16,9 +17,20 @@
 #include "skin.h"
 #include "skin_movement.h"
 
+#if defined(GODDARD_SKIN_VERIFY) && !defined(FIXED_POINT_GODDARD)
+#error "GODDARD_SKIN_VERIFY compares against the fixed-point backend, so it needs FIXED_POINT_GODDARD"
+#endif
+
 // bss
 struct ObjNet *gGdSkinNet; // @ 801BAAF0
 
+#ifdef GODDARD_SKIN_VERIFY
+struct GdSkinVerifyStats gGdSkinVerify;
+
+// Vertices are drawn at whole units, so differences well under one aren't visible
+#define VERIFY_EPSILON 0.1f
+#endif
+
 static s32 D_801BAAF4;
 static s32 sNetCount; // @ 801BAAF8
 
@@ -345,6 +357,32 @@ void convert_gd_verts_to_Vn(struct ObjGroup *grp) {
     }
 }
 
+#ifdef FIXED_POINT_GODDARD
+/**
+ * Fixed-point version of convert_gd_verts_to_Vtx, which writes the skinned positions straight
+ * into the display list's vertices. Dividing truncates toward zero, like the float casts.
+ */
+static void convert_gd_verts_to_Vtx_fixed(struct ObjGroup *grp) {
+    register struct VtxLink *vtxlink;
+    register struct ListNode *link;
+    struct ObjVertex *vtx;
+    s16 x, y, z;
+
+    for (link = grp->firstMember; link != NULL; link = link->next) {
+        vtx = (struct ObjVertex *) link->obj;
+        x = (s16)(vtx->fixedPos.x / GD_FIXED_POS_ONE);
+        y = (s16)(vtx->fixedPos.y / GD_FIXED_POS_ONE);
+        z = (s16)(vtx->fixedPos.z / GD_FIXED_POS_ONE);
+
+        for (vtxlink = vtx->gbiVerts; vtxlink != NULL; vtxlink = vtxlink->prev) {
+            vtxlink->data->v.ob[0] = x;
+            vtxlink->data->v.ob[1] = y;
+            vtxlink->data->v.ob[2] = z;
+        }
+    }
+}
+#endif
+
 /* 241AB4 -> 241BCC; orig name: func_801932E4 */
 void convert_gd_verts_to_Vtx(struct ObjGroup *grp) {
     UNUSED u8 filler[24];
@@ -359,6 +397,11 @@ void convert_gd_verts_to_Vtx(struct ObjGroup *grp) {
     register struct ListNode *link;      // t3
     struct GdObj *obj;                // sp4
 
+#ifdef FIXED_POINT_GODDARD
+    convert_gd_verts_to_Vtx_fixed(grp);
+    return;
+#endif
+
     for (link = grp->firstMember; link != NULL; link = link->next) {
         obj = link->obj;
         vtx = (struct ObjVertex *) obj;
@@ -452,12 +495,55 @@ void move_net(struct ObjNet *net) {
     }
 }
 
+#ifdef FIXED_POINT_GODDARD
+/**
+ * Once every joint has added its weights, copy the fixed-point skin back to the float positions
+ * that bounding boxes and normals read. With GODDARD_SKIN_VERIFY, the float backend has skinned
+ * the same vertices, so compare them first.
+ */
+static void finish_skin_fixed(struct ObjNet *net) {
+    register struct ListNode *link;
+    struct ObjVertex *vtx;
+    struct GdVec3f pos;
+#ifdef GODDARD_SKIN_VERIFY
+    f32 error;
+#endif
+
+    if (net->netType != 2 || net->shapePtr == NULL) {
+        return;
+    }
+
+    for (link = net->shapePtr->scaledVtxGroup->firstMember; link != NULL; link = link->next) {
+        vtx = (struct ObjVertex *) link->obj;
+        pos.x = (f32) vtx->fixedPos.x * (1.0f / GD_FIXED_POS_ONE);
+        pos.y = (f32) vtx->fixedPos.y * (1.0f / GD_FIXED_POS_ONE);
+        pos.z = (f32) vtx->fixedPos.z * (1.0f / GD_FIXED_POS_ONE);
+
+#ifdef GODDARD_SKIN_VERIFY
+        error = ABS(pos.x - vtx->pos.x) + ABS(pos.y - vtx->pos.y) + ABS(pos.z - vtx->pos.z);
+        gGdSkinVerify.vertices++;
+        if (error > VERIFY_EPSILON) {
+            gGdSkinVerify.mismatches++;
+        }
+        if (error > gGdSkinVerify.maxError) {
+            gGdSkinVerify.maxError = error;
+        }
+#endif
+
+        vtx->pos = pos;
+    }
+}
+#endif
+
 /* 241E94 -> 241F0C; orig name: func_801936C4 */
 void move_nets(struct ObjGroup *group) {
     imin("move_nets");
     restart_timer("move_nets");
     apply_to_obj_types_in_group(OBJ_TYPE_NETS, (applyproc_t) func_80192294, group);
     apply_to_obj_types_in_group(OBJ_TYPE_NETS, (applyproc_t) move_net, group);
+#ifdef FIXED_POINT_GODDARD
+    apply_to_obj_types_in_group(OBJ_TYPE_NETS, (applyproc_t) finish_skin_fixed, group);
+#endif
     split_timer("move_nets");
     imout();
 }
@@ -475,6 +561,13 @@ void func_8019373C(struct ObjNet *net) {
                     vtx = (struct ObjVertex *) link->obj;
                     if (vtx->scaleFactor != 1.0) {
                         addto_group(net->shapePtr->scaledVtxGroup, &vtx->header);
+#ifdef FIXED_POINT_GODDARD
+                        // The weights have all been reset, so the base position is final
+                        vtx->fixedBase.x = (s32)(vtx->initPos.x * vtx->scaleFactor * GD_FIXED_POS_ONE);
+                        vtx->fixedBase.y = (s32)(vtx->initPos.y * vtx->scaleFactor * GD_FIXED_POS_ONE);
+                        vtx->fixedBase.z = (s32)(vtx->initPos.z * vtx->scaleFactor * GD_FIXED_POS_ONE);
+                        gd_vec3f_to_fixed(&vtx->fixedPos, &vtx->pos);
+#endif
                     }
                 }
             }
@@ -8,6 +8,17 @@
 // bss
 extern struct ObjNet* gGdSkinNet;   // @ 801BAAF0
 
+#ifdef GODDARD_SKIN_VERIFY
+// Results of skinning every vertex with both the fixed-point and float backends
+struct GdSkinVerifyStats {
+    u32 vertices;
+    u32 mismatches;
+    f32 maxError;
+};
+
+extern struct GdSkinVerifyStats gGdSkinVerify;
+#endif
+
 // functions
 void reset_net(struct ObjNet *net);
 struct ObjNet *make_net(UNUSED s32 a0, struct ObjShape *shapedata, struct ObjGroup *a2,
@@ -68,15 +68,71 @@ void scale_verts(struct ObjGroup *a0) {
     }
 }
 
+#ifdef FIXED_POINT_GODDARD
+/**
+ * Fixed-point version of scale_verts, starting each skinned vertex from the base position that
+ * was converted when its weights were reset.
+ */
+static void scale_verts_fixed(struct ObjGroup *grp) {
+    register struct ListNode *link;
+    struct ObjVertex *vtx;
+
+    for (link = grp->firstMember; link != NULL; link = link->next) {
+        vtx = (struct ObjVertex *) link->obj;
+        vtx->fixedPos = vtx->fixedBase;
+    }
+}
+#endif
+
 /* @ 23000C for 0x58; orig name: func8018183C*/
 void move_skin(struct ObjNet *net) {
     UNUSED u8 filler[8];
 
     if (net->shapePtr != NULL) {
+#ifdef FIXED_POINT_GODDARD
+        scale_verts_fixed(net->shapePtr->scaledVtxGroup);
+#ifndef GODDARD_SKIN_VERIFY
+        return;
+#endif
+#endif
         scale_verts(net->shapePtr->scaledVtxGroup);
     }
 }
 
+#ifdef FIXED_POINT_GODDARD
+/**
+ * Fixed-point version of func_80181894. The joint's matrix is converted once, and each weight's
+ * offset and value were converted when the weights were reset.
+ */
+static void add_joint_weights_fixed(struct ObjJoint *joint) {
+    register struct ListNode *link;
+    register struct ObjWeight *curWeight;
+    register struct ObjVertex *connectedVtx;
+    struct GdFixedVec3 offset;
+    GdFixedMat4x3 mtx;
+    s32 weight;
+
+    if (joint->weightGrp == NULL) {
+        return;
+    }
+
+    gd_mat4f_to_fixed(&mtx, &joint->matE8);
+    for (link = joint->weightGrp->firstMember; link != NULL; link = link->next) {
+        curWeight = (struct ObjWeight *) link->obj;
+
+        if ((weight = curWeight->fixedWeight) > 0) {
+            offset = curWeight->fixedVec20;
+            gd_fixed_rotate_and_translate_vec3(&offset, &mtx);
+
+            connectedVtx = curWeight->vtx;
+            connectedVtx->fixedPos.x += (s32)(((s64) offset.x * weight) >> GD_FIXED_ROT_SHIFT);
+            connectedVtx->fixedPos.y += (s32)(((s64) offset.y * weight) >> GD_FIXED_ROT_SHIFT);
+            connectedVtx->fixedPos.z += (s32)(((s64) offset.z * weight) >> GD_FIXED_ROT_SHIFT);
+        }
+    }
+}
+#endif
+
 /* @ 230064 for 0x13C*/
 void func_80181894(struct ObjJoint *joint) {
     register struct ObjGroup *weightGroup; // baseGroup? weights Only?
@@ -87,6 +143,13 @@ void func_80181894(struct ObjJoint *joint) {
     register f32 scaleFactor;
     struct GdObj *linkedObj;
 
+#ifdef FIXED_POINT_GODDARD
+    add_joint_weights_fixed(joint);
+#ifndef GODDARD_SKIN_VERIFY
+    return;
+#endif
+#endif
+
     weightGroup = joint->weightGrp;
     if (weightGroup != NULL) {
         for (link = weightGroup->firstMember; link != NULL; link = link->next) {
@@ -125,6 +188,10 @@ void reset_weight_vtx(struct ObjVertex *vtx) {
         sResetCurWeight->vec20.x = localVec.x;
         sResetCurWeight->vec20.y = localVec.y;
         sResetCurWeight->vec20.z = localVec.z;
+#ifdef FIXED_POINT_GODDARD
+        gd_vec3f_to_fixed(&sResetCurWeight->fixedVec20, &localVec);
+        sResetCurWeight->fixedWeight = (s32)(sResetCurWeight->weightVal * GD_FIXED_ROT_ONE);
+#endif
 
         vtx->scaleFactor -= sResetCurWeight->weightVal;
     }
@@ -0,0 +1,21 @@
+#include <ultra64.h>
+
+#include "macros.h"
+#include "lib/src/osContInternal.h"
+
+// No input is ever pressed, so runs are driven by the game's own demo playback and are repeatable
+
+s32 osContInit(UNUSED OSMesgQueue *mq, u8 *controllerBits, UNUSED OSContStatus *status) {
+    *controllerBits = 1;
+    return 0;
+}
+
+s32 osContStartReadData(UNUSED OSMesgQueue *mesg) {
+    return 0;
+}
+
+void osContGetReadData(OSContPad *pad) {
+    pad->button = 0;
+    pad->stick_x = 0;
+    pad->stick_y = 0;
+}
@@ -0,0 +1,500 @@
+#include <nds.h>
+#include <nds/arm9/postest.h>
+#include <filesystem.h>
+
+#include "host_gx.h"
+#include "c_button.h"
+#include "stick.h"
+#include "stick_base_1.h"
+#include "stick_base_2.h"
+
+// Matrix stack sizes on hardware; the projection stack only holds one matrix
+#define POSITION_STACK_SIZE 31
+#define PROJECTION_STACK_SIZE 1
+
+// Geometry RAM limits, where the hardware usage counters stop
+#define POLYGON_RAM_SIZE 2048
+#define VERTEX_RAM_SIZE 6144
+
+#define TEXTURE_COUNT 4096
+#define VRAM_BLOCK_COUNT 2048
+
+struct VramAlloc {
+    u32 id;
+    u32 addr;
+    u32 size;
+};
+
+struct s_vramBlock {
+    u32 base;
+    u32 size;
+    u32 next_id;
+    u32 count;
+    struct VramAlloc allocs[VRAM_BLOCK_COUNT]; // Sorted by address
+};
+
+struct HostGxStats host_gx_stats;
+
+vu16 GFX_POLYGON_RAM_USAGE;
+vu16 GFX_VERTEX_RAM_USAGE;
+vu32 VRAM_CR;
+u16 BG_PALETTE[0x400];
+vu16 REG_BG3CNT;
+vs16 REG_BG3PA, REG_BG3PB, REG_BG3PC, REG_BG3PD;
+vs32 REG_BG3X, REG_BG3Y;
+vu16 REG_BLDCNT;
+OamState oamSub;
+
+const unsigned int c_buttonBitmap[2048];
+const unsigned int stickBitmap[2048];
+const unsigned int stick_base_1Bitmap[2048];
+const unsigned int stick_base_2Bitmap[2048];
+
+static gl_texture_data textures[TEXTURE_COUNT];
+static bool texture_used[TEXTURE_COUNT];
+
+// Texture VRAM in banks A to C, and palette VRAM in bank E
+static struct s_vramBlock texture_block = { .base = 0x6800000, .size = 0x60000, .next_id = 1 };
+static struct s_vramBlock palette_block = { .base = 0x6880000, .size = 0x10000, .next_id = 1 };
+
+static gl_hidden_globals globals = {
+    .texturePtrs = { .data = textures },
+    .vramBlocks = { &texture_block, &palette_block },
+};
+gl_hidden_globals *glGlob = &globals;
+
+static m4x4 projection;
+static m4x4 position;
+static m4x4 projection_stack[PROJECTION_STACK_SIZE];
+static m4x4 position_stack[POSITION_STACK_SIZE];
+static int projection_sp;
+static int position_sp;
+static int matrix_mode;
+
+static int prim_type;
+static u32 prim_vertices;
+static int32 pos_result[4];
+
+static void (*vblank_handler)();
+
+static u16 sprite_gfx[8][64 * 64];
+static int sprite_count;
+
+static vu32 register_sink;
+
+static void write_words(u32 count) {
+    host_gx_stats.words += count;
+}
+
+static void multiply(m4x4 *dst, const m4x4 *a, const m4x4 *b) {
+    // Multiply two matrices with 12-bit fractionals, like the geometry engine does
+    m4x4 result;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            int64_t sum = 0;
+            for (int k = 0; k < 4; k++)
+                sum += (int64_t)a->m[i * 4 + k] * b->m[k * 4 + j];
+            result.m[i * 4 + j] = sum >> 12;
+        }
+    }
+    *dst = result;
+}
+
+static m4x4 *current_matrix() {
+    return (matrix_mode == GL_PROJECTION) ? &projection : &position;
+}
+
+static void count_vertex() {
+    // Count polygons as they're completed, following the vertex sharing of each primitive type
+    // Vertices in strips are shared between polygons, so vertex RAM usage goes up by one per vertex either way
+    prim_vertices++;
+    host_gx_stats.vertices++;
+    if (GFX_VERTEX_RAM_USAGE < VERTEX_RAM_SIZE)
+        GFX_VERTEX_RAM_USAGE++;
+
+    bool polygon;
+    switch (prim_type) {
+        case GL_TRIANGLE:       polygon = (prim_vertices % 3 == 0);                       break;
+        case GL_QUAD:           polygon = (prim_vertices % 4 == 0);                       break;
+        case GL_TRIANGLE_STRIP: polygon = (prim_vertices >= 3);                           break;
+        default:                polygon = (prim_vertices >= 4 && !(prim_vertices & 1)); break;
+    }
+
+    if (polygon) {
+        host_gx_stats.polygons++;
+        if (GFX_POLYGON_RAM_USAGE < POLYGON_RAM_SIZE)
+            GFX_POLYGON_RAM_USAGE++;
+    }
+}
+
+vu32 *host_gx_write() {
+    write_words(1);
+    return &register_sink;
+}
+
+void glInit() {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+void glClearColor(u8 red, u8 green, u8 blue, u8 alpha) {}
+void glClearDepth(u16 depth) {}
+void glEnable(int bits) {}
+void glDisable(int bits) {}
+void glFogColor(u8 red, u8 green, u8 blue, u8 alpha) {}
+void glFogDensity(int index, int density) {}
+void glFogShift(int shift) {}
+void glFogOffset(int offset) {}
+
+void glFlush(u32 mode) {
+    // Geometry RAM is swapped at the next V-blank, so the usage counters start over
+    write_words(1);
+    GFX_POLYGON_RAM_USAGE = 0;
+    GFX_VERTEX_RAM_USAGE = 0;
+}
+
+void glViewport(u8 x1, u8 y1, u8 x2, u8 y2) {
+    write_words(1);
+}
+
+void glMatrixMode(int mode) {
+    write_words(1);
+    matrix_mode = mode;
+}
+
+void glPushMatrix() {
+    write_words(1);
+    host_gx_stats.matrix_pushes++;
+
+    // Overflowing a stack sets an error flag on hardware and the push is lost
+    if (matrix_mode == GL_PROJECTION) {
+        if (projection_sp < PROJECTION_STACK_SIZE)
+            projection_stack[projection_sp++] = projection;
+    } else if (position_sp < POSITION_STACK_SIZE) {
+        position_stack[position_sp++] = position;
+    }
+}
+
+void glPopMatrix(int num) {
+    write_words(1);
+    if (matrix_mode == GL_PROJECTION) {
+        if ((projection_sp -= num) < 0)
+            projection_sp = 0;
+        projection = projection_stack[projection_sp];
+    } else {
+        if ((position_sp -= num) < 0)
+            position_sp = 0;
+        position = position_stack[position_sp];
+    }
+}
+
+void glLoadIdentity() {
+    write_words(1);
+    m4x4 *cur = current_matrix();
+    memset(cur, 0, sizeof(*cur));
+    cur->m[0] = cur->m[5] = cur->m[10] = cur->m[15] = 1 << 12;
+}
+
+void glLoadMatrix4x4(const m4x4 *m) {
+    write_words(16);
+    host_gx_stats.matrix_loads++;
+    *current_matrix() = *m;
+}
+
+void glMultMatrix4x4(const m4x4 *m) {
+    write_words(16);
+    host_gx_stats.matrix_loads++;
+    multiply(current_matrix(), m, current_matrix());
+}
+
+void glGetFixed(int param, int *f) {
+    // The vector matrix is only changed in modelview mode here, so it always matches the position matrix's rotation
+    host_gx_stats.matrix_reads++;
+    if (param == GL_GET_MATRIX_CLIP) {
+        m4x4 clip;
+        multiply(&clip, &position, &projection);
+        memcpy(f, clip.m, sizeof(clip.m));
+    } else {
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                f[i * 3 + j] = position.m[i * 4 + j];
+    }
+}
+
+void PosTest(v16 x, v16 y, v16 z) {
+    write_words(2);
+    m4x4 clip;
+    multiply(&clip, &position, &projection);
+    for (int j = 0; j < 4; j++) {
+        pos_result[j] = ((int64_t)x * clip.m[j] + (int64_t)y * clip.m[4 + j] +
+                         (int64_t)z * clip.m[8 + j] + ((int64_t)clip.m[12 + j] << 12)) >> 12;
+    }
+}
+
+int32 PosTestXresult() { return pos_result[0]; }
+int32 PosTestYresult() { return pos_result[1]; }
+int32 PosTestZresult() { return pos_result[2]; }
+int32 PosTestWresult() { return pos_result[3]; }
+
+void glPolyFmt(u32 params) {
+    write_words(1);
+}
+
+void glBegin(int mode) {
+    write_words(1);
+    prim_type = mode;
+    prim_vertices = 0;
+}
+
+void glColor3b(u8 red, u8 green, u8 blue) {
+    write_words(1);
+}
+
+void glTexCoord2t16(t16 u, t16 v) {
+    write_words(1);
+}
+
+void glVertex3v16(v16 x, v16 y, v16 z) {
+    write_words(2);
+    count_vertex();
+}
+
+void glCallList(const u32 *list) {
+    // The list is sent by DMA, so its commands are walked to count what it draws
+    const u32 size = list[0];
+    write_words(size);
+    host_gx_stats.list_calls++;
+
+    for (u32 i = 1; i <= size;) {
+        const u32 pack = list[i++];
+        for (int slot = 0; slot < 4; slot++) {
+            switch ((pack >> (slot * 8)) & 0xFF) {
+                case FIFO_BEGIN:
+                    prim_type = list[i++];
+                    prim_vertices = 0;
+                    break;
+                case FIFO_VERTEX16:
+                    count_vertex();
+                    i += 2;
+                    break;
+                case FIFO_COLOR:
+                case FIFO_TEX_COORD:
+                    i++;
+                    break;
+            }
+        }
+    }
+}
+
+void *DynamicArrayGet(DynamicArray *v, unsigned int index) {
+    return (index < TEXTURE_COUNT) ? &v->data[index] : NULL;
+}
+
+u32 vramBlock_allocateBlock(s_vramBlock *mb, u32 size, u8 align) {
+    // Place the block in the first gap that fits it, keeping the allocations sorted by address
+    if (mb->count == VRAM_BLOCK_COUNT)
+        return 0;
+
+    const u32 mask = (1 << align) - 1;
+    u32 addr = (mb->base + mask) & ~mask;
+    u32 i;
+    for (i = 0; i < mb->count; i++) {
+        if (addr + size <= mb->allocs[i].addr)
+            break;
+        addr = (mb->allocs[i].addr + mb->allocs[i].size + mask) & ~mask;
+    }
+    if (addr + size > mb->base + mb->size)
+        return 0;
+
+    memmove(&mb->allocs[i + 1], &mb->allocs[i], (mb->count - i) * sizeof(struct VramAlloc));
+    mb->allocs[i].id = mb->next_id++;
+    mb->allocs[i].addr = addr;
+    mb->allocs[i].size = size;
+    mb->count++;
+    return mb->allocs[i].id;
+}
+
+static int find_alloc(s_vramBlock *mb, u32 index) {
+    for (u32 i = 0; i < mb->count; i++) {
+        if (mb->allocs[i].id == index)
+            return i;
+    }
+    return -1;
+}
+
+u32 vramBlock_deallocateBlock(s_vramBlock *mb, u32 index) {
+    const int i = find_alloc(mb, index);
+    if (i < 0)
+        return 0;
+
+    memmove(&mb->allocs[i], &mb->allocs[i + 1], (mb->count - i - 1) * sizeof(struct VramAlloc));
+    mb->count--;
+    return 1;
+}
+
+void *vramBlock_getAddr(s_vramBlock *mb, u32 index) {
+    const int i = find_alloc(mb, index);
+    return (i < 0) ? NULL : (void*)(uintptr_t)mb->allocs[i].addr;
+}
+
+int glGenTextures(int n, int *names) {
+    // Name 0 is kept as no texture
+    for (int i = 0; i < n; i++) {
+        names[i] = 0;
+        for (int name = 1; name < TEXTURE_COUNT; name++) {
+            if (!texture_used[name]) {
+                texture_used[name] = true;
+                memset(&textures[name], 0, sizeof(textures[name]));
+                names[i] = name;
+                break;
+            }
+        }
+        if (!names[i])
+            return 0;
+    }
+    return 1;
+}
+
+int glDeleteTextures(int n, int *names) {
+    for (int i = 0; i < n; i++) {
+        gl_texture_data *tex = &textures[names[i]];
+        if (tex->texIndex)
+            vramBlock_deallocateBlock(&texture_block, tex->texIndex);
+        if (tex->texIndexExt)
+            vramBlock_deallocateBlock(&texture_block, tex->texIndexExt);
+        memset(tex, 0, sizeof(*tex));
+        texture_used[names[i]] = false;
+        if (glGlob->activeTexture == names[i])
+            glGlob->activeTexture = 0;
+        names[i] = 0;
+    }
+    return 1;
+}
+
+void glBindTexture(int target, int name) {
+    write_words(1);
+    host_gx_stats.texture_binds++;
+    glGlob->activeTexture = name;
+}
+
+void glTexParameter(int target, int param) {
+    write_words(1);
+    gl_texture_data *tex = &textures[glGlob->activeTexture];
+    tex->texFormat = (tex->texFormat & 0x1FF0FFFF) | param;
+}
+
+u32 glGetTexParameter() {
+    return textures[glGlob->activeTexture].texFormat;
+}
+
+int glColorTableEXT(int target, int empty1, u16 width, int empty2, int empty3, const u16 *table) {
+    write_words(1);
+    return vramBlock_allocateBlock(&palette_block, width * 2, 4) != 0;
+}
+
+void vramSetBankA(int mode) {}
+void vramSetBankB(int mode) {}
+void vramSetBankC(int mode) {}
+void vramSetBankD(int mode) {}
+void vramSetBankE(int mode) {}
+void vramSetBankF(int mode) {}
+void vramSetBankG(int mode) {}
+void vramRestorePrimaryBanks(u32 vramTemp) {}
+
+int glLockVRAMBank(u16 *addr) {
+    // Only bank E is palette VRAM here, so the banks that get locked are never allocated from anyway
+    return 1;
+}
+
+u16 *vramGetBank(u16 *addr) {
+    // Banks A to D are 128KB each, and bank E follows them
+    const uintptr_t a = (uintptr_t)addr;
+    return (u16*)((a >= (uintptr_t)VRAM_E) ? (uintptr_t)VRAM_E : (a & ~0x1FFFF));
+}
+
+// Copies into VRAM are only counted by the renderer, and the source data usually isn't there when replaying
+void dmaCopyWords(u8 channel, const void *src, void *dest, u32 size) {}
+void dmaCopy(const void *source, void *dest, u32 size) {}
+
+void videoSetMode(u32 mode) {}
+void videoSetModeSub(u32 mode) {}
+void videoBgEnable(int number) {}
+void videoBgDisable(int number) {}
+void consoleDemoInit() {}
+
+void oamInit(OamState *oam, int mapping, bool extPalette) {}
+void oamClear(OamState *oam, int start, int count) {}
+void oamUpdate(OamState *oam) {}
+void oamSet(OamState *oam, int id, int x, int y, int priority, int palette_alpha, int size, int format,
+    const void *gfxOffset, int affineIndex, bool sizeDouble, bool hide, bool hflip, bool vflip, bool mosaic) {}
+
+u16 *oamAllocateGfx(OamState *oam, int size, int colorFormat) {
+    return (sprite_count < 8) ? sprite_gfx[sprite_count++] : NULL;
+}
+
+void irqSet(u32 irq, void (*handler)()) {
+    if (irq == IRQ_VBLANK)
+        vblank_handler = handler;
+}
+
+void irqEnable(u32 irq) {}
+
+// Nothing interrupts the game here, since V-blank only comes when it's waited for
+int enterCriticalSection() { return 0; }
+void leaveCriticalSection(int oldIME) {}
+
+void swiWaitForVBlank() {
+    // V-blank comes right away, so waiting for it only runs the handler
+    if (vblank_handler)
+        vblank_handler();
+}
+
+void DC_FlushRange(const void *base, u32 size) {}
+
+bool nitroFSInit(char **basepath) {
+    return true;
+}
+
+void swiDecompressLZSSWram(const void *source, void *destination) {
+    // Follow each flag byte's bits from the top, copying either a literal byte or an earlier run
+    const u8 *src = source;
+    u8 *dst = destination;
+    u8 *end = dst + ((src[1] | (src[2] << 8) | (src[3] << 16)));
+    src += 4;
+
+    while (dst < end) {
+        u8 flags = *src++;
+        for (int i = 0; i < 8 && dst < end; i++, flags <<= 1) {
+            if (flags & 0x80) {
+                u32 length = (src[0] >> 4) + 3;
+                const u8 *copy = dst - (((src[0] & 0xF) << 8) | src[1]) - 1;
+                src += 2;
+                while (length-- && dst < end)
+                    *dst++ = *copy++;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+    }
+}
+
+s32 sqrt64(s64 a) {
+    // Integer square root, rounded down like the hardware divider does
+    uint64_t value = a;
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > value)
+        bit >>= 2;
+    while (bit) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifndef HOST_GX_H
+#define HOST_GX_H
+
+#include <stdint.h>
+
+// Work the renderer gave the geometry engine, counted by the libnds stand-in in host_gx.c
+struct HostGxStats {
+    uint32_t words;         // Words written to the geometry FIFO, including those sent by command lists
+    uint32_t texture_binds;
+    uint32_t matrix_pushes;
+    uint32_t matrix_loads;  // Matrix loads and multiplies, at 16 words each
+    uint32_t matrix_reads;  // Matrix read-backs, which wait for the geometry engine to go idle on hardware
+    uint32_t list_calls;
+    uint32_t polygons;      // Polygons and vertices as sent, before any culling or clipping
+    uint32_t vertices;
+};
+
+extern struct HostGxStats host_gx_stats;
+
+#endif // HOST_GX_H
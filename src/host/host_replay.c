@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ultra64.h>
+
+#include "game/game_init.h"
+#include "nds/nds_gx_list.h"
+#include "nds/nds_profiler.h"
+#include "nds/nds_renderer.h"
+#include "nds/nds_trace.h"
+#include "host_gx.h"
+#include "host_replay.h"
+#include "host_residency.h"
+
+// Frames captured with TRACE_CAPTURE are run through the DS renderer again, with the libnds stand-in counting
+// the work it generates instead of drawing anything
+
+#define STORE_SIZE 16384 // Must be a power of 2
+
+// Blocks outside the display list pool are kept between frames at the same host address, so the renderer's
+// texture cache sees the same texture at the same address each time, like it would on hardware
+struct StoredBlock {
+    uint32_t address;
+    uint32_t type;
+    uint32_t size;
+    uint8_t *data;
+};
+
+static Gfx replay_pool[GFX_POOL_SIZE];
+static bool pool_patched[GFX_POOL_SIZE];
+static uint32_t pool_start;
+
+static struct StoredBlock store[STORE_SIZE];
+static uint32_t store_count;
+
+// Anything the trace doesn't have a copy of points here, which reads as the end of a display list
+static Gfx missing_block[16];
+
+static uint32_t opcode_counts[0x100];
+static uint32_t frame_commands;
+
+static uint64_t render_start;
+static uint64_t render_time;
+
+static uint64_t now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void profiler_switch_phase(enum ProfilerPhase phase) {
+    // The renderer marks the start and end of its work with these, so the time between them is what's measured
+    if (phase == PHASE_RENDER) {
+        render_start = now_us();
+    } else if (phase == PHASE_WAIT) {
+        render_time = now_us() - render_start;
+    }
+}
+
+static bool in_pool(uint32_t address) {
+    return address - pool_start < sizeof(replay_pool);
+}
+
+static struct StoredBlock *find_stored(uint32_t address, uint32_t type) {
+    // Look up a block by its address on the DS and its type, using the address as the hash
+    uint32_t index = (address >> 3) & (STORE_SIZE - 1);
+    while (store[index].data != NULL && (store[index].address != address || store[index].type != type)) {
+        index = (index + 1) & (STORE_SIZE - 1);
+    }
+    return &store[index];
+}
+
+static bool store_block(const struct TraceBlock *block, const uint8_t *data) {
+    // Refresh the kept copy of a block, growing it if this frame used more of it
+    struct StoredBlock *stored = find_stored(block->address, block->type);
+    if (stored->data == NULL) {
+        if (store_count == STORE_SIZE * 3 / 4)
+            return false;
+        stored->address = block->address;
+        stored->type = block->type;
+        store_count++;
+    }
+
+    if (stored->data == NULL || block->size > stored->size) {
+        stored->data = realloc(stored->data, block->size ? block->size : 1);
+        stored->size = block->size;
+    }
+
+    memcpy(stored->data, data, block->size);
+    return true;
+}
+
+static uint32_t translate(uint32_t address, uint32_t type) {
+    // Get the host address of a copied block from its address on the DS
+    if (in_pool(address))
+        return (uint32_t)(uintptr_t)((uint8_t*)replay_pool + (address - pool_start));
+
+    const struct StoredBlock *stored = find_stored(address, type);
+    return (uint32_t)(uintptr_t)(stored->data ? stored->data : (uint8_t*)missing_block);
+}
+
+static void patch_list(Gfx *cmd, uint32_t count) {
+    // Point the commands of a copied display list at the copies of what they reference
+    // Lists in the pool can overlap, so each command there is only patched once
+    for (uint32_t i = 0; i < count; i++, cmd++) {
+        if ((uint8_t*)cmd >= (uint8_t*)replay_pool && cmd < replay_pool + GFX_POOL_SIZE) {
+            if (pool_patched[cmd - replay_pool])
+                continue;
+            pool_patched[cmd - replay_pool] = true;
+        }
+
+        switch (cmd->words.w0 >> 24) {
+            case G_VTX:     cmd->words.w1 = translate(cmd->words.w1, TRACE_VTX); break;
+            case G_MTX:     cmd->words.w1 = translate(cmd->words.w1, TRACE_MTX); break;
+            case G_MOVEMEM: cmd->words.w1 = translate(cmd->words.w1, TRACE_MEM); break;
+            case G_SETTIMG: cmd->words.w1 = translate(cmd->words.w1, TRACE_TEX); break;
+            case G_DL:      cmd->words.w1 = translate(cmd->words.w1, TRACE_DL);  break;
+        }
+    }
+}
+
+static void count_commands(const Gfx *cmd) {
+    // Walk the patched lists the same way the renderer executes them, counting every command
+    while (true) {
+        const uint8_t opcode = cmd->words.w0 >> 24;
+        opcode_counts[opcode]++;
+        frame_commands++;
+
+        if (opcode == G_DL) {
+            if (cmd->words.w0 & (1 << 16)) { // Without return
+                cmd = (const Gfx*)cmd->words.w1;
+                continue;
+            }
+            count_commands((const Gfx*)cmd->words.w1);
+        } else if (opcode == G_ENDDL) {
+            return;
+        }
+
+        cmd++;
+    }
+}
+
+static bool load_frame(const struct TraceFrame *frame) {
+    const struct TraceBlock *blocks = (const struct TraceBlock*)(frame + 1);
+    const uint8_t *data = (const uint8_t*)(blocks + frame->block_count);
+
+    pool_start = frame->root;
+    memset(pool_patched, 0, sizeof(pool_patched));
+
+    // Copy every block into place before patching, since copies into the pool can overlap
+    const uint8_t *src = data;
+    for (uint32_t i = 0; i < frame->block_count; i++) {
+        const struct TraceBlock *block = &blocks[i];
+        if (in_pool(block->address)) {
+            if (block->address - pool_start + block->size <= sizeof(replay_pool))
+                memcpy((uint8_t*)replay_pool + (block->address - pool_start), src, block->size);
+        } else if (!store_block(block, src)) {
+            return false;
+        }
+        src += (block->size + 3) & ~3;
+    }
+
+    for (uint32_t i = 0; i < frame->block_count; i++) {
+        if (blocks[i].type == TRACE_DL)
+            patch_list((Gfx*)(uintptr_t)translate(blocks[i].address, TRACE_DL), blocks[i].size / sizeof(Gfx));
+    }
+
+    return true;
+}
+
+static uint8_t *read_file(const char *path, uint32_t *size) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *data = malloc(*size ? *size : 1);
+    if (data != NULL && fread(data, 1, *size, fp) != *size) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(fp);
+    return data;
+}
+
+static uint32_t index_frames(const uint8_t *data, uint32_t size, const struct TraceFrame ***frames) {
+    // Find the start of each frame, stopping at anything that doesn't look like one (like a capture cut short)
+    uint32_t count = 0;
+    uint32_t offset = 0;
+    *frames = NULL;
+
+    while (offset + sizeof(struct TraceFrame) <= size) {
+        const struct TraceFrame *frame = (const struct TraceFrame*)(data + offset);
+        const uint32_t table_size = frame->block_count * sizeof(struct TraceBlock);
+        if (frame->magic != TRACE_MAGIC || size - offset - sizeof(struct TraceFrame) < table_size ||
+            size - offset - sizeof(struct TraceFrame) - table_size < frame->data_size)
+            break;
+
+        // The blocks have to add up to the data that follows them
+        const struct TraceBlock *blocks = (const struct TraceBlock*)(frame + 1);
+        uint32_t data_size = 0;
+        for (uint32_t i = 0; i < frame->block_count; i++)
+            data_size += (blocks[i].size + 3) & ~3;
+        if (data_size != frame->data_size)
+            break;
+
+        *frames = realloc(*frames, (count + 1) * sizeof(**frames));
+        (*frames)[count++] = frame;
+        offset += sizeof(struct TraceFrame) + table_size + frame->data_size;
+    }
+
+    if (offset != size)
+        printf("Ignoring %u bytes of the trace after frame %u\n", size - offset, count);
+    return count;
+}
+
+static uint32_t print_stats() {
+    uint32_t mismatches = 0;
+
+    printf("Commands:\n");
+    for (int i = 0; i < 0x100; i++) {
+        if (opcode_counts[i])
+            printf("  0x%.2X: %u\n", i, opcode_counts[i]);
+    }
+
+    printf("Tex: %u hit, %u miss, %u evict, %u defer, %u repack, %u KB\n", texture_stats.hits, texture_stats.misses,
+           texture_stats.evictions, texture_stats.deferred, texture_stats.repacks, texture_stats.bytes_uploaded >> 10);
+    printf("GX lists: %u hit, %u new, %u flushes, %u words\n", gx_list_stats.hits, gx_list_stats.compiled,
+           gx_list_stats.flushes, gx_list_stats.words_used);
+    printf("Skipped: %u dyn, %u 2D, %u first, %u clash\n", gx_list_stats.skipped[GX_SKIP_DYNAMIC],
+           gx_list_stats.skipped[GX_SKIP_2D], gx_list_stats.skipped[GX_SKIP_FIRST], gx_list_stats.skipped[GX_SKIP_CLASH]);
+#ifdef GX_LIST_VERIFY
+    printf("GX verify: %u/%u differ\n", gx_list_stats.mismatches, gx_list_stats.verified);
+    mismatches += gx_list_stats.mismatches;
+#endif
+#ifdef PROJECTION_VERIFY
+    printf("Projection: %u/%u differ\n", projection_verify.mismatches, projection_verify.vertices);
+    printf("Clip: %u/%u differ\n", projection_verify.matrix_mismatches, projection_verify.matrices);
+    mismatches += projection_verify.mismatches + projection_verify.matrix_mismatches;
+#endif
+    printf("Verts: %u sent, %u saved\n", vertex_stats.submitted, vertex_stats.saved);
+    printf("Culled: %u chunks, %u tris\n", vertex_stats.chunks_culled, vertex_stats.tris_culled);
+    printf("Matrix: %u loads, %u pushes, %u reads; %u list calls\n", host_gx_stats.matrix_loads,
+           host_gx_stats.matrix_pushes, host_gx_stats.matrix_reads, host_gx_stats.list_calls);
+
+    return mismatches;
+}
+
+int replay_trace(const char *path, uint32_t passes) {
+    if (passes == 0)
+        passes = 1;
+
+    uint32_t size;
+    uint8_t *data = read_file(path, &size);
+    if (data == NULL) {
+        printf("Couldn't read %s\n", path);
+        return 1;
+    }
+
+    const struct TraceFrame **frames;
+    const uint32_t count = index_frames(data, size, &frames);
+    if (count == 0) {
+        printf("No frames in %s\n", path);
+        return 1;
+    }
+
+    for (int i = 0; i < 16; i++)
+        missing_block[i].words.w0 = G_ENDDL << 24;
+
+    renderer_init();
+
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        // Caches stay warm between passes, but the counters only cover the last one
+        memset(opcode_counts, 0, sizeof(opcode_counts));
+        memset(&texture_stats, 0, sizeof(texture_stats));
+        memset(&vertex_stats, 0, sizeof(vertex_stats));
+#ifdef PROJECTION_VERIFY
+        memset(&projection_verify, 0, sizeof(projection_verify));
+#endif
+        memset(&host_gx_stats, 0, sizeof(host_gx_stats));
+        gx_list_reset_stats();
+        residency_start_pass();
+
+        uint64_t total_time = 0;
+        uint64_t max_time = 0;
+
+        printf("Pass %u:\n", pass + 1);
+        for (uint32_t i = 0; i < count; i++) {
+            if (!load_frame(frames[i])) {
+                printf("Too many blocks in frame %u\n", i);
+                return 1;
+            }
+
+            frame_commands = 0;
+            count_commands(replay_pool);
+
+            const struct HostGxStats before = host_gx_stats;
+            draw_frame(replay_pool);
+            residency_next_frame();
+
+            printf("%4u  level %2d area %d  %6u cmds %7u words %5u binds %5u pushes %5u polys %6u us\n", i,
+                   frames[i]->level, frames[i]->area, frame_commands, host_gx_stats.words - before.words,
+                   host_gx_stats.texture_binds - before.texture_binds, host_gx_stats.matrix_pushes - before.matrix_pushes,
+                   host_gx_stats.polygons - before.polygons, (uint32_t) render_time);
+
+            total_time += render_time;
+            if (render_time > max_time)
+                max_time = render_time;
+        }
+
+        printf("%u frames: %u words avg, %u us avg, %u us max\n", count, host_gx_stats.words / count,
+               (uint32_t) (total_time / count), (uint32_t) max_time);
+    }
+
+    const uint32_t mismatches = print_stats();
+    residency_report();
+
+    // Fail if any verification check found a difference
+    free(frames);
+    free(data);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+#ifndef HOST_REPLAY_H
+#define HOST_REPLAY_H
+
+#include <stdint.h>
+
+extern int replay_trace(const char *path, uint32_t passes);
+
+#endif // HOST_REPLAY_H
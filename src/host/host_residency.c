@@ -0,0 +1,193 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+
+#include "nds/nds_renderer.h"
+#include "host_residency.h"
+
+// Texture lookups made by the renderer while replaying a trace are recorded, then run through other residency policies
+// with the same VRAM size and upload budget, so the renderer's LRU can be compared against them
+// VRAM is treated as a single pool of bytes, so fragmentation and repacking aren't simulated
+
+#define TEXTURE_SLOTS 4096 // Must be a power of 2, and more than the renderer's texture map holds
+#define NEVER 0xFFFFFFFF
+
+enum Policy {
+    POLICY_FIFO, // Evict in load order, even textures still needed this frame, like the renderer used to
+    POLICY_LRU,  // Evict the least recently used texture not needed this frame, like the renderer does now
+    POLICY_OPT,  // Evict the texture needed again furthest in the future, as a lower bound for any policy
+    POLICY_COUNT
+};
+
+struct TextureUse {
+    uint32_t texture;
+    uint32_t frame;
+    uint32_t next_use; // Index of the next use of the same texture
+};
+
+struct SimTexture {
+    const void *address;
+    uint32_t bytes;
+};
+
+struct PolicyStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t deferred;
+    uint32_t bytes_uploaded;
+};
+
+static struct SimTexture textures[TEXTURE_SLOTS];
+
+static struct TextureUse *uses;
+static uint32_t use_count;
+static uint32_t use_capacity;
+static uint32_t pass_start;
+static uint32_t frame;
+
+void residency_record(const void *address, uint32_t bytes) {
+    // Look up the texture using its address as the hash, like the renderer does
+    uint32_t index = ((uint32_t)(uintptr_t)address >> 5) & (TEXTURE_SLOTS - 1);
+    while (textures[index].address != address && textures[index].address != NULL) {
+        index = (index + 1) & (TEXTURE_SLOTS - 1);
+    }
+    textures[index].address = address;
+    textures[index].bytes = bytes;
+
+    if (use_count == use_capacity) {
+        use_capacity = use_capacity ? use_capacity * 2 : 0x4000;
+        uses = realloc(uses, use_capacity * sizeof(*uses));
+    }
+
+    uses[use_count].texture = index;
+    uses[use_count].frame = frame;
+    use_count++;
+}
+
+void residency_start_pass() {
+    // Earlier passes still warm up the simulated VRAM, but only uses from here on are counted
+    pass_start = use_count;
+}
+
+void residency_next_frame() {
+    frame++;
+}
+
+static void link_uses() {
+    // Find the next use of each texture after every use, for the optimal policy
+    static uint32_t next[TEXTURE_SLOTS];
+    for (int i = 0; i < TEXTURE_SLOTS; i++)
+        next[i] = NEVER;
+
+    for (uint32_t i = use_count; i-- > 0;) {
+        uses[i].next_use = next[uses[i].texture];
+        next[uses[i].texture] = i;
+    }
+}
+
+static bool better_victim(enum Policy policy, uint32_t a, uint32_t b, const uint32_t *loaded, const uint32_t *last_used,
+                          const uint32_t *next_use) {
+    // Check if texture a should be evicted before texture b
+    switch (policy) {
+        case POLICY_FIFO: return loaded[a] < loaded[b];
+        case POLICY_LRU:  return last_used[a] < last_used[b];
+        default:          return next_use[a] > next_use[b];
+    }
+}
+
+static void simulate(enum Policy policy, struct PolicyStats *stats) {
+    static bool resident[TEXTURE_SLOTS];
+    static uint32_t loaded[TEXTURE_SLOTS];
+    static uint32_t last_used[TEXTURE_SLOTS];
+    static uint32_t next_use[TEXTURE_SLOTS];
+    static uint16_t list[TEXTURE_SLOTS];
+
+    uint32_t count = 0;
+    uint32_t load_count = 0;
+    uint32_t resident_bytes = 0;
+    uint32_t upload_bytes = 0;
+    uint32_t cur_frame = NEVER;
+
+    memset(resident, 0, sizeof(resident));
+    memset(stats, 0, sizeof(*stats));
+
+    for (uint32_t i = 0; i < use_count; i++) {
+        const uint32_t id = uses[i].texture;
+        const uint32_t bytes = textures[id].bytes;
+        const bool counted = (i >= pass_start);
+
+        // The upload budget starts over every frame
+        if (uses[i].frame != cur_frame) {
+            cur_frame = uses[i].frame;
+            upload_bytes = 0;
+        }
+        next_use[id] = uses[i].next_use;
+
+        if (resident[id]) {
+            last_used[id] = cur_frame;
+            if (counted) stats->hits++;
+            continue;
+        }
+
+        // Defer the texture if it would go over this V-blank's upload budget, like the renderer
+        bool fits = (upload_bytes == 0 || upload_bytes + bytes <= UPLOAD_BUDGET);
+
+        // Evict until the texture fits; only FIFO will evict textures that are still needed this frame
+        while (fits && resident_bytes + bytes > TEXTURE_VRAM_SIZE) {
+            int victim = -1;
+            for (uint32_t j = 0; j < count; j++) {
+                if (policy != POLICY_FIFO && last_used[list[j]] == cur_frame)
+                    continue;
+                if (victim < 0 || better_victim(policy, list[j], list[victim], loaded, last_used, next_use))
+                    victim = j;
+            }
+
+            if (victim < 0) {
+                fits = false;
+                break;
+            }
+
+            resident[list[victim]] = false;
+            resident_bytes -= textures[list[victim]].bytes;
+            list[victim] = list[--count];
+            if (counted) stats->evictions++;
+        }
+
+        if (!fits) {
+            if (counted) stats->deferred++;
+            continue;
+        }
+
+        resident[id] = true;
+        list[count++] = id;
+        loaded[id] = load_count++;
+        last_used[id] = cur_frame;
+        resident_bytes += bytes;
+        upload_bytes += bytes;
+        if (counted) {
+            stats->misses++;
+            stats->bytes_uploaded += bytes;
+        }
+    }
+}
+
+void residency_report() {
+    static const char *names[POLICY_COUNT] = { "FIFO", "LRU", "OPT" };
+
+    if (use_count == 0)
+        return;
+
+    link_uses();
+
+    printf("Residency with %u KB of VRAM and %u KB per V-blank:\n", TEXTURE_VRAM_SIZE >> 10, UPLOAD_BUDGET >> 10);
+    for (int i = 0; i < POLICY_COUNT; i++) {
+        struct PolicyStats stats;
+        simulate(i, &stats);
+        printf("  %-4s %u hit, %u miss, %u evict, %u defer, %u KB\n", names[i], stats.hits, stats.misses,
+               stats.evictions, stats.deferred, stats.bytes_uploaded >> 10);
+    }
+}
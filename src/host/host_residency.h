@@ -0,0 +1,8 @@
+#ifndef HOST_RESIDENCY_H
+#define HOST_RESIDENCY_H
+
+extern void residency_start_pass();
+extern void residency_next_frame();
+extern void residency_report();
+
+#endif // HOST_RESIDENCY_H
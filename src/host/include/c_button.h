@@ -0,0 +1,8 @@
+#ifndef HOST_C_BUTTON_H
+#define HOST_C_BUTTON_H
+
+// Touch screen graphics aren't converted for the host build, so this is left blank (see host_gx.c)
+extern const unsigned int c_buttonBitmap[2048];
+#define c_buttonBitmapLen 8192
+
+#endif // HOST_C_BUTTON_H
@@ -0,0 +1,9 @@
+#ifndef HOST_FILESYSTEM_H
+#define HOST_FILESYSTEM_H
+
+#include <stdbool.h>
+
+// NitroFS is a folder in the build directory on the host, so there's nothing to mount
+extern bool nitroFSInit(char **basepath);
+
+#endif // HOST_FILESYSTEM_H
@@ -0,0 +1,242 @@
+#ifndef HOST_NDS_H
+#define HOST_NDS_H
+
+// The parts of libnds used by the DS renderer, backed by host_gx.c
+// Nothing is drawn; geometry commands update the matrix stacks and are counted, so display lists can be replayed
+// through the real renderer code to measure how much work they would give the geometry engine
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t u8;
+typedef int8_t s8;
+typedef uint16_t u16;
+typedef int16_t s16;
+typedef uint32_t u32;
+typedef int32_t s32;
+typedef uint64_t u64;
+typedef int64_t s64;
+typedef volatile u16 vu16;
+typedef volatile s16 vs16;
+typedef volatile u32 vu32;
+typedef volatile s32 vs32;
+
+typedef int32_t int32;
+typedef int16_t v16;
+typedef int16_t t16;
+
+typedef struct { int32 m[16]; } m4x4;
+
+#define BIT(n) (1 << (n))
+#define DTCM_BSS
+#define ITCM_CODE
+
+#define RGB15(r, g, b) ((r) | ((g) << 5) | ((b) << 10))
+#define ARGB16(a, r, g, b) (((a) << 15) | (r) | ((g) << 5) | ((b) << 10))
+#define TEXTURE_PACK(u, v) (((u) & 0xFFFF) | ((v) << 16))
+#define VERTEX_PACK(a, b) (((a) & 0xFFFF) | ((b) << 16))
+
+// Geometry command IDs, as packed into command lists
+#define FIFO_NOP       0x00
+#define FIFO_COLOR     0x20
+#define FIFO_TEX_COORD 0x22
+#define FIFO_VERTEX16  0x23
+#define FIFO_BEGIN     0x40
+
+enum {
+    POLY_DECAL      = (1 << 4),
+    POLY_CULL_FRONT = (1 << 6),
+    POLY_CULL_BACK  = (2 << 6),
+    POLY_CULL_NONE  = (3 << 6),
+    POLY_FOG        = (1 << 15)
+};
+
+#define POLY_ALPHA(n) ((n) << 16)
+#define POLY_ID(n) ((n) << 24)
+
+typedef enum {
+    GL_NOTEXTURE,
+    GL_RGB32_A3,
+    GL_RGB4,
+    GL_RGB16,
+    GL_RGB256,
+    GL_COMPRESSED,
+    GL_RGB8_A5,
+    GL_RGBA,
+    GL_RGB
+} GL_TEXTURE_TYPE_ENUM;
+
+enum {
+    GL_TEXTURE_WRAP_S = (1 << 16),
+    GL_TEXTURE_WRAP_T = (1 << 17),
+    GL_TEXTURE_FLIP_S = (1 << 18),
+    GL_TEXTURE_FLIP_T = (1 << 19),
+    GL_TEXTURE_COLOR0_TRANSPARENT = (1 << 29),
+    TEXGEN_TEXCOORD = (1 << 30)
+};
+
+enum { GL_TRIANGLE, GL_QUAD, GL_TRIANGLE_STRIP, GL_QUAD_STRIP };
+enum { GL_PROJECTION, GL_POSITION, GL_MODELVIEW, GL_TEXTURE };
+enum { GL_TEXTURE_2D = 1, GL_TOON_HIGHLIGHT = 2, GL_BLEND = 8, GL_ANTIALIAS = 16, GL_FOG = 128 };
+enum { GL_GET_MATRIX_VECTOR, GL_GET_MATRIX_CLIP };
+
+#define GL_TRANS_MANUALSORT (1 << 0)
+#define GL_MAX_DEPTH 0x7FFF
+
+// Texture names index a fixed table here instead of a growing array
+typedef struct {
+    void *vramAddr;
+    u32 texIndex;
+    u32 texIndexExt;
+    u32 texFormat;
+    u32 texSize;
+} gl_texture_data;
+
+typedef struct { gl_texture_data *data; } DynamicArray;
+typedef struct s_vramBlock s_vramBlock;
+
+typedef struct {
+    DynamicArray texturePtrs;
+    s_vramBlock *vramBlocks[2];
+    int activeTexture;
+} gl_hidden_globals;
+
+extern gl_hidden_globals *glGlob;
+
+extern void *DynamicArrayGet(DynamicArray *v, unsigned int index);
+extern u32 vramBlock_allocateBlock(s_vramBlock *mb, u32 size, u8 align);
+extern u32 vramBlock_deallocateBlock(s_vramBlock *mb, u32 index);
+extern void *vramBlock_getAddr(s_vramBlock *mb, u32 index);
+
+// Register writes and reads that the renderer does directly
+extern vu32 *host_gx_write();
+extern vu16 GFX_POLYGON_RAM_USAGE;
+extern vu16 GFX_VERTEX_RAM_USAGE;
+extern vu32 VRAM_CR;
+
+// Commands are executed as soon as they're written on the host, so the geometry engine is never busy
+#define GFX_BUSY 0
+#define GFX_PAL_FORMAT (*host_gx_write())
+
+extern void glInit();
+extern void glClearColor(u8 red, u8 green, u8 blue, u8 alpha);
+extern void glClearDepth(u16 depth);
+extern void glEnable(int bits);
+extern void glDisable(int bits);
+extern void glFlush(u32 mode);
+extern void glViewport(u8 x1, u8 y1, u8 x2, u8 y2);
+extern void glFogColor(u8 red, u8 green, u8 blue, u8 alpha);
+extern void glFogDensity(int index, int density);
+extern void glFogShift(int shift);
+extern void glFogOffset(int offset);
+
+extern void glMatrixMode(int mode);
+extern void glPushMatrix();
+extern void glPopMatrix(int num);
+extern void glLoadIdentity();
+extern void glLoadMatrix4x4(const m4x4 *m);
+extern void glMultMatrix4x4(const m4x4 *m);
+extern void glGetFixed(int param, int *f);
+
+extern void glPolyFmt(u32 params);
+extern void glBegin(int mode);
+extern void glColor3b(u8 red, u8 green, u8 blue);
+extern void glTexCoord2t16(t16 u, t16 v);
+extern void glVertex3v16(v16 x, v16 y, v16 z);
+extern void glCallList(const u32 *list);
+
+extern int glGenTextures(int n, int *names);
+extern int glDeleteTextures(int n, int *names);
+extern void glBindTexture(int target, int name);
+extern void glTexParameter(int target, int param);
+extern u32 glGetTexParameter();
+extern int glColorTableEXT(int target, int empty1, u16 width, int empty2, int empty3, const u16 *table);
+extern int glLockVRAMBank(u16 *addr);
+
+// VRAM banks are only given addresses to compare; nothing is ever read or written through them
+#define VRAM_A ((u16*)0x6800000)
+#define VRAM_B ((u16*)0x6820000)
+#define VRAM_C ((u16*)0x6840000)
+#define VRAM_D ((u16*)0x6860000)
+#define VRAM_E ((u16*)0x6880000)
+#define VRAM_F ((u16*)0x6890000)
+#define VRAM_G ((u16*)0x6894000)
+
+enum {
+    VRAM_A_LCD, VRAM_A_TEXTURE,
+    VRAM_B_LCD, VRAM_B_TEXTURE,
+    VRAM_C_LCD, VRAM_C_TEXTURE,
+    VRAM_D_LCD, VRAM_D_SUB_SPRITE,
+    VRAM_E_LCD, VRAM_E_TEX_PALETTE,
+    VRAM_F_MAIN_BG_0x06000000,
+    VRAM_G_MAIN_BG_0x06004000
+};
+
+extern void vramSetBankA(int mode);
+extern void vramSetBankB(int mode);
+extern void vramSetBankC(int mode);
+extern void vramSetBankD(int mode);
+extern void vramSetBankE(int mode);
+extern void vramSetBankF(int mode);
+extern void vramSetBankG(int mode);
+extern u16 *vramGetBank(u16 *addr);
+extern void vramRestorePrimaryBanks(u32 vramTemp);
+extern void dmaCopyWords(u8 channel, const void *src, void *dest, u32 size);
+extern void dmaCopy(const void *source, void *dest, u32 size);
+
+enum { MODE_0_2D = 0x10000, MODE_0_3D = 0x10100, MODE_5_3D = 0x10105 };
+extern u16 BG_PALETTE[0x400];
+extern void videoSetMode(u32 mode);
+extern void videoSetModeSub(u32 mode);
+extern void videoBgEnable(int number);
+extern void videoBgDisable(int number);
+
+// Background registers are plain variables, and background VRAM is only given addresses like the banks above
+extern vu16 REG_BG3CNT;
+extern vs16 REG_BG3PA, REG_BG3PB, REG_BG3PC, REG_BG3PD;
+extern vs32 REG_BG3X, REG_BG3Y;
+extern vu16 REG_BLDCNT;
+
+#define BG_RS_32x32 (1 << 14)
+#define BG_WRAP_ON (1 << 13)
+#define BG_PRIORITY(n) (n)
+#define BG_TILE_BASE(base) ((base) << 2)
+#define BG_MAP_BASE(base) ((base) << 8)
+#define BG_TILE_RAM(base) ((u16*)(0x6000000 + ((base) << 14)))
+#define BG_MAP_RAM(base) ((u16*)(0x6000000 + ((base) << 11)))
+
+enum { BLEND_ALPHA = (1 << 6), BLEND_SRC_BG0 = (1 << 0), BLEND_DST_BG3 = (1 << 11) };
+extern void consoleDemoInit();
+
+typedef struct { int unused; } OamState;
+enum { SpriteMapping_Bmp_1D_128 };
+enum { SpriteSize_64x64 = 0xE080 };
+enum { SpriteColorFormat_Bmp = 3 };
+
+extern OamState oamSub;
+extern void oamInit(OamState *oam, int mapping, bool extPalette);
+extern void oamClear(OamState *oam, int start, int count);
+extern void oamUpdate(OamState *oam);
+extern u16 *oamAllocateGfx(OamState *oam, int size, int colorFormat);
+extern void oamSet(OamState *oam, int id, int x, int y, int priority, int palette_alpha, int size, int format,
+    const void *gfxOffset, int affineIndex, bool sizeDouble, bool hide, bool hflip, bool vflip, bool mosaic);
+
+// The V-blank handler runs whenever V-blank is waited for
+enum { IRQ_VBLANK = BIT(0) };
+extern void irqSet(u32 irq, void (*handler)());
+extern void irqEnable(u32 irq);
+extern void swiWaitForVBlank();
+extern int enterCriticalSection();
+extern void leaveCriticalSection(int oldIME);
+
+extern s32 sqrt64(s64 a);
+
+// Decompresses the BIOS LZ77 format for segments streamed from NitroFS, which is a plain folder here
+extern void swiDecompressLZSSWram(const void *source, void *destination);
+
+// There is only one CPU here, so there is no cache to write back for the other one
+extern void DC_FlushRange(const void *base, u32 size);
+
+#endif // HOST_NDS_H
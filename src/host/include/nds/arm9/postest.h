@@ -0,0 +1,12 @@
+#ifndef HOST_POSTEST_H
+#define HOST_POSTEST_H
+
+// Position tests are calculated from the current clip matrix in host_gx.c
+
+extern void PosTest(v16 x, v16 y, v16 z);
+extern int32 PosTestXresult();
+extern int32 PosTestYresult();
+extern int32 PosTestZresult();
+extern int32 PosTestWresult();
+
+#endif // HOST_POSTEST_H
@@ -0,0 +1,8 @@
+#ifndef HOST_STICK_H
+#define HOST_STICK_H
+
+// Touch screen graphics aren't converted for the host build, so this is left blank (see host_gx.c)
+extern const unsigned int stickBitmap[2048];
+#define stickBitmapLen 8192
+
+#endif // HOST_STICK_H
@@ -0,0 +1,8 @@
+#ifndef HOST_STICK_BASE_1_H
+#define HOST_STICK_BASE_1_H
+
+// Touch screen graphics aren't converted for the host build, so this is left blank (see host_gx.c)
+extern const unsigned int stick_base_1Bitmap[2048];
+#define stick_base_1BitmapLen 8192
+
+#endif // HOST_STICK_BASE_1_H
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ultra64.h>
+
+#include "audio/data.h"
+#include "audio/external.h"
+#include "audio/seqplayer.h"
+#include "engine/behavior_script.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
+#include "game/game_init.h"
+#include "game/memory.h"
+#include "game/object_collision.h"
+#include "game/object_helpers.h"
+#include "game/object_list_processor.h"
+#include "game/profiler.h"
+#include "game/rendering_graph_node.h"
+#include "goddard/dynlist_proc.h"
+#include "goddard/renderer.h"
+#include "goddard/skin.h"
+#include "nds/nds_profiler.h"
+#include "host_replay.h"
+
+// The OS time is kept in DS bus clock ticks, so times read through osGetTime mean the same as on the DS
+#define HOST_CLOCK_RATE 33513982
+
+// Audio is updated at 30 Hz with this many sequence ticks each, like the DS timer interrupt does
+#define AUDIO_TICKS_PER_FRAME 8
+
+#define DEFAULT_FRAMES 1800
+
+extern struct ProfilerFrameData gProfilerFrameData[2];
+extern s16 gCurrentFrameIndex1;
+
+enum HostPhase {
+    HOST_SCRIPT,  // Level script and everything it runs, except object updates
+    HOST_OBJECTS, // Object and surface updates
+    HOST_GRAPH,   // Walking the scene graph and building the display list
+    HOST_AUDIO,   // Sound effect and sequence updates
+    HOST_PHASE_COUNT
+};
+
+static u32 frame_limit = DEFAULT_FRAMES;
+static u32 frame_count;
+static u64 phase_total[HOST_PHASE_COUNT];
+static u64 phase_max[HOST_PHASE_COUNT];
+static u64 run_start;
+
+uint64_t profiler_timer_read() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * HOST_CLOCK_RATE + (uint64_t) ts.tv_nsec * HOST_CLOCK_RATE / 1000000000;
+}
+
+static u32 to_us(u64 ticks) {
+    return (u32) (ticks * 1000000 / HOST_CLOCK_RATE);
+}
+
+static void add_phase(enum HostPhase phase, u64 ticks) {
+    phase_total[phase] += ticks;
+    if (ticks > phase_max[phase])
+        phase_max[phase] = ticks;
+}
+
+static u64 update_audio(void) {
+    const u64 start = profiler_timer_read();
+
+    // Run the same updates as the DS audio interrupt, without handing the notes to anything
+    update_game_sound();
+    gAudioFrameCount += 2;
+    gAudioRandom = ((gAudioRandom + gAudioFrameCount) * gAudioFrameCount);
+    for (int i = 0; i < AUDIO_TICKS_PER_FRAME; i++)
+        process_sequences(0);
+
+    return profiler_timer_read() - start;
+}
+
+static u32 print_report(void) {
+    static const char *names[HOST_PHASE_COUNT] = { "Script", "Objects", "Graph", "Audio" };
+    static const char *alloc_names[ALLOC_KIND_COUNT] = { "Main pool", "Alloc-only", "Mem pool", "Display list" };
+    const u64 elapsed = profiler_timer_read() - run_start;
+    u32 mismatches = 0;
+
+    printf("%u frames in %u ms\n", frame_count, to_us(elapsed) / 1000);
+
+    // Average and worst frame time of each subsystem
+    for (int i = 0; i < HOST_PHASE_COUNT; i++) {
+        printf("%-8s %8u us avg %8u us max\n", names[i], to_us(phase_total[i] / frame_count), to_us(phase_max[i]));
+    }
+
+    // Allocations made over the whole run, including level loads
+    for (int i = 0; i < ALLOC_KIND_COUNT; i++) {
+        printf("%-12s %8u allocs %10u bytes\n", alloc_names[i], gMemoryAllocStats.count[i], gMemoryAllocStats.bytes[i]);
+    }
+
+    // Animated limbs that reused a pose from another object with the same animation and frame
+    printf("Pose cache   %8u hits %10u misses\n", gPoseCacheStats.hits, gPoseCacheStats.misses);
+
+    // Behavior commands run over the whole run, by command number, and how many script words were decoded
+    printf("Bhv decoded  %8u words\n", gBhvCommandStats.decodedWords);
+    for (int i = 0; i < BHV_CMD_COUNT; i++) {
+        if (gBhvCommandStats.counts[i])
+            printf("Bhv cmd 0x%.2X %8u runs\n", i, gBhvCommandStats.counts[i]);
+    }
+
+    // Object surfaces rebuilt from their collision data, and ones reused from the frame before
+    printf("Surfaces     %8u rebuilt %9u reused\n", gDynamicSurfaceStats.rebuilt, gDynamicSurfaceStats.reused);
+
+    // Object draws skipped because the object's room couldn't be seen from Mario's
+    printf("Rooms        %8u hidden\n", gRoomVisibilityStats.hidden);
+
+    // Building the Mario head at boot, and the object name lookups its dynlists made
+    printf("Head setup   %8u us %11u lookups %8u probes\n", to_us(gGdmSetupTime), gDynObjLookupStats.lookups,
+           gDynObjLookupStats.probes);
+
+#ifdef COLLISION_VERIFY
+    // Collision queries where the fixed-point and float backends disagreed, and the last one's position
+    printf("Collision: %u/%u differ\n", gCollisionVerify.mismatches, gCollisionVerify.queries);
+    if (gCollisionVerify.mismatches) {
+        printf("  %c %d %d %d\n", gCollisionVerify.lastType, (int)gCollisionVerify.lastPos[0],
+               (int)gCollisionVerify.lastPos[1], (int)gCollisionVerify.lastPos[2]);
+    }
+    mismatches += gCollisionVerify.mismatches;
+#endif
+
+#ifdef OBJ_COLLISION_VERIFY
+    // Frames where the object collision broadphase changed which objects collided
+    printf("Obj collision: %u/%u frames differ\n", gObjCollisionVerify.mismatches, gObjCollisionVerify.frames);
+    mismatches += gObjCollisionVerify.mismatches;
+#endif
+
+#ifdef DYNAMIC_SURFACE_VERIFY
+    // Objects whose rebuilt surfaces differed from the ones that would have been reused
+    printf("Obj surfaces: %u differ, %u checked\n", gDynamicSurfaceVerify.mismatches, gDynamicSurfaceVerify.surfaces);
+    mismatches += gDynamicSurfaceVerify.mismatches;
+#endif
+
+#ifdef DYNOBJ_INDEX_VERIFY
+    // Head object name lookups where the index found something other than a linear scan would have
+    printf("Dynobj index: %u/%u differ\n", gDynObjLookupStats.mismatches, gDynObjLookupStats.lookups);
+    mismatches += gDynObjLookupStats.mismatches;
+#endif
+
+#ifdef STATIC_SURFACE_VERIFY
+    // Static partition lists that came out in a different order than sorted insertion would give
+    printf("Static lists: %u/%u differ\n", gStaticSurfaceVerify.mismatches, gStaticSurfaceVerify.lists);
+    mismatches += gStaticSurfaceVerify.mismatches;
+#endif
+
+#ifdef GODDARD_SKIN_VERIFY
+    // Skinned head vertices where the fixed-point and float backends disagreed, and the worst error
+    printf("Head skin: %u/%u differ, max %d/1000\n", gGdSkinVerify.mismatches, gGdSkinVerify.vertices,
+           (int)(gGdSkinVerify.maxError * 1000));
+    mismatches += gGdSkinVerify.mismatches;
+#endif
+
+    return mismatches;
+}
+
+void exec_display_list(UNUSED struct SPTask *spTask) {
+    // The display list isn't drawn; this only collects the times logged by the game loop for this frame
+    const struct ProfilerFrameData *profiler = &gProfilerFrameData[gCurrentFrameIndex1];
+    const u64 script = profiler->gameTimes[LEVEL_SCRIPT_EXECUTE] - profiler->gameTimes[THREAD5_START];
+    const u64 objects = gObjectUpdateCycles[7];
+
+    add_phase(HOST_SCRIPT, (script > objects) ? script - objects : 0);
+    add_phase(HOST_OBJECTS, objects);
+    add_phase(HOST_GRAPH, profiler->gameTimes[BEFORE_DISPLAY_LISTS] - profiler->gameTimes[LEVEL_SCRIPT_EXECUTE]);
+    add_phase(HOST_AUDIO, update_audio());
+
+    // Objects aren't updated on every frame, so don't count the last update twice
+    gObjectUpdateCycles[7] = 0;
+
+    // Exit with an error if any verification check found a difference
+    if (++frame_count == frame_limit) {
+        exit(print_report() ? 1 : 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    static u64 pool[0x165000 / sizeof(u64)];
+
+    // Replay captured display lists through the renderer instead of running the game, if given a trace
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+        return replay_trace(argv[2], (argc > 3) ? strtoul(argv[3], NULL, 0) : 1);
+
+    // The number of frames to run can be given on the command line
+    if (argc > 1)
+        frame_limit = strtoul(argv[1], NULL, 0);
+    if (frame_limit == 0)
+        frame_limit = DEFAULT_FRAMES;
+
+    main_pool_init(pool, pool + sizeof(pool) / sizeof(pool[0]));
+    gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
+
+    audio_init();
+    sound_init();
+
+    // Run the game; with no input, the title screen falls through to the attract mode demos, so every run is the same
+    run_start = profiler_timer_read();
+    thread5_game_loop(NULL);
+
+    return 0;
+}
@@ -2,7 +2,7 @@
 
 #include "nds_audio.h"
 
-struct Note *gNotes;
+static struct AudioRing *audio_ring;
 static bool running;
 
 static void send_input(void) {
@@ -10,12 +10,11 @@ static void send_input(void) {
 }
 
 static void update_audio(void) {
-    // Request an audio update from the ARM9
-    IPC_SendSync(0);
-    swiIntrWait(0, IRQ_IPC_SYNC);
-
-    // Play the current notes
-    play_notes(gNotes);
+    // Play the next channel states from the ARM9, or keep the current ones if it's running behind
+    if (audio_ring_count(audio_ring) > 0) {
+        play_notes(audio_ring_read_slot(audio_ring));
+        audio_ring_pop(audio_ring);
+    }
 }
 
 static void power_down(void) {
@@ -33,15 +32,15 @@ int main(void) {
 
     SetYtrigger(80);
     irqSet(IRQ_VCOUNT, send_input);
-    irqEnable(IRQ_VCOUNT | IRQ_IPC_SYNC);
+    irqEnable(IRQ_VCOUNT);
 
-    // Get a pointer to the audio data from the ARM9
+    // Get a pointer to the audio ring from the ARM9
     while (!fifoCheckValue32(FIFO_USER_01));
-    gNotes = (struct Note*)fifoGetValue32(FIFO_USER_01);
+    audio_ring = (struct AudioRing*)fifoGetValue32(FIFO_USER_01);
 
     // Prepare to update the audio at 240 Hz
     enableSound();
-    timerStart(0, ClockDivider_64, TIMER_FREQ_64(240), update_audio);
+    timerStart(0, ClockDivider_64, TIMER_FREQ_64(AUDIO_TICK_RATE), update_audio);
     running = true;
 
     // Wait idly for interrupts
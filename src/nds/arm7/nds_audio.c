@@ -15,10 +15,10 @@ static u16 calculate_freq(f32 frequency) {
     return SOUND_FREQ((u16)freq);
 }
 
-static u32 calculate_vol_pan(const struct Note *note) {
+static u32 calculate_vol_pan(const struct AudioChannelState *note) {
     // Calculate the DS volume and pan values for a note
-    u32 vol = note->targetVolLeft + note->targetVolRight;
-    u32 pan = (vol << 13) / note->targetVolLeft;
+    u32 vol = note->volLeft + note->volRight;
+    u32 pan = (vol << 13) / note->volLeft;
     vol >>= 8;
     pan >>= 8;
     if (vol > 127) vol = 127;
@@ -26,15 +26,15 @@ static u32 calculate_vol_pan(const struct Note *note) {
     return SOUND_VOL(vol) | SOUND_PAN(pan);
 }
 
-void play_notes(struct Note *notes) {
+void play_notes(const struct AudioTick *tick) {
     // Play notes on the 16 sound channels of the DS
     // The samples are converted to DS ADPCM at compile time, so they can be played directly
     for (int i = 0; i < 16; i++) {
-        struct Note *note = &notes[i];
+        const struct AudioChannelState *note = &tick->channels[i];
 
-        if (note->enabled && note->sound != NULL) {
-            if (note->needsInit || ((SCHANNEL_CR(i) & SCHANNEL_ENABLE) && (note->frequency >= 2.0f) != (bool)(high_freqs & BIT(i)))) {
-                const struct AudioBankSample *sample = note->sound->sample;
+        if (note->sample != NULL) {
+            if (note->init || ((SCHANNEL_CR(i) & SCHANNEL_ENABLE) && (note->frequency >= 2.0f) != (bool)(high_freqs & BIT(i)))) {
+                const struct AudioBankSample *sample = note->sample;
                 const u32 loop = (sample->loop->count ? SOUND_REPEAT : SOUND_ONE_SHOT);
 
                 // Ensure the channel is properly reset
@@ -58,8 +58,6 @@ void play_notes(struct Note *notes) {
 
                 // Start the channel
                 SCHANNEL_CR(i) = SCHANNEL_ENABLE | SOUND_FORMAT_ADPCM | calculate_vol_pan(note) | loop;
-
-                note->needsInit = false;
             } else if (SCHANNEL_CR(i) & SCHANNEL_ENABLE) {
                 // Update the parameters of a currently playing note
                 SCHANNEL_TIMER(i) = calculate_freq(note->frequency / ((high_freqs & BIT(i)) ? 2 : 1));
@@ -1,8 +1,8 @@
 #ifndef NDS_AUDIO_H
 #define NDS_AUDIO_H
 
-#include "audio/load.h"
+#include "../nds_audio_ring.h"
 
-extern void play_notes(struct Note *notes);
+extern void play_notes(const struct AudioTick *tick);
 
 #endif // NDS_AUDIO_H
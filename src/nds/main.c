@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "nds_include.h"
 #include <fat.h>
@@ -7,47 +8,208 @@
 #include "audio/external.h"
 #include "audio/load.h"
 #include "audio/seqplayer.h"
+#include "engine/behavior_script.h"
+#include "engine/surface_collision.h"
+#include "engine/surface_load.h"
 #include "game/game_init.h"
+#include "game/object_collision.h"
+#include "game/object_helpers.h"
+#include "game/rendering_graph_node.h"
+#include "goddard/dynlist_proc.h"
+#include "goddard/renderer.h"
+#include "goddard/skin.h"
 #include "nds_renderer.h"
+#include "nds_audio_ring.h"
+#include "nds_gx_list.h"
+#include "nds_budget.h"
+#include "nds_profiler.h"
+#include "nds_segments.h"
+#include "game/profiler.h"
 
 u8 nds_audio_state;
 static u8 audio_step;
 static u8 fps;
 
+// Shared with the ARM7, and only accessed through the uncached RAM mirror
+static struct AudioRing audio_ring_data;
+static struct AudioRing *audio_ring;
+
 void exec_display_list(struct SPTask *spTask) {
     draw_frame((Gfx*)spTask->task.t.data_ptr);
     fps++;
 }
 
+static void push_notes(void) {
+    // Copy the state of each note into the ring for the ARM7 to play
+    struct AudioTick *tick = audio_ring_write_slot(audio_ring);
+    for (int i = 0; i < 16; i++) {
+        struct Note *note = &gNotes[i];
+        struct AudioChannelState *channel = &tick->channels[i];
+
+        if (note->enabled && note->sound != NULL) {
+            channel->sample = note->sound->sample;
+            channel->frequency = note->frequency;
+            channel->volLeft = note->targetVolLeft;
+            channel->volRight = note->targetVolRight;
+            channel->init = note->needsInit;
+            note->needsInit = false;
+        } else {
+            channel->sample = NULL;
+        }
+    }
+    audio_ring_push(audio_ring);
+}
+
 static void update_audio(void) {
-    // Update audio at the ARM7's request
+    // Sequencing takes a while, so let other interrupts through while it runs, so V-blank isn't held up
+    // This timer's own interrupt stays off until it's done, so it can't nest; it still preempts game code wherever
+    // that happens to be, since the sequence player runs on the ARM9 (see nds_audio_ring.h)
+    irqDisable(IRQ_TIMER1);
+    REG_IME = 1;
+    profiler_audio_begin();
+
+    // Update audio in batches at 60 Hz, half a frame ahead of the ARM7
     if (nds_audio_state == 0) {
         // Update the audio logic at 30 Hz
-        if ((audio_step = (audio_step + 1) & 7) == 0) {
+        if ((audio_step ^= 1) != 0) {
+            profiler_log_thread4_time();
             update_game_sound();
+            profiler_log_thread4_time();
             gAudioFrameCount += 2;
             gAudioRandom = ((gAudioRandom + gAudioFrameCount) * gAudioFrameCount);
         }
 
-        // Update the sequences at 240 Hz
-        process_sequences(0);
+        // Update the sequences at 240 Hz, stopping early if the ARM7 has fallen behind and the ring is full
+        for (int i = 0; i < AUDIO_TICKS_PER_BATCH && audio_ring_count(audio_ring) < AUDIO_RING_SIZE; i++) {
+            process_sequences(0);
+            push_notes();
+        }
     } else if (nds_audio_state == 1) {
         // Disable audio
         for (int i = 0; i < 16; i++) {
             gNotes[i].enabled = false;
         }
-        nds_audio_state = 2;
+        if (audio_ring_count(audio_ring) < AUDIO_RING_SIZE) {
+            push_notes();
+            nds_audio_state = 2;
+        }
     }
 
-    // Tell the ARM7 it can go ahead
-    IPC_SendSync(0);
+    profiler_audio_end();
+    REG_IME = 0;
+    irqEnable(IRQ_TIMER1);
 }
 
 static void update_fps(void) {
-    // Draw and reset the FPS counter
+    // Draw the FPS counter
     consoleClear();
     printf("FPS: %d\n", fps);
+
+    // Show where the frame time went
+    profiler_print();
+
+    // Report how many vertex batches were sent as compiled GX lists, and why the others weren't
+    printf("GX lists: %lu hit, %lu new\n", gx_list_stats.hits, gx_list_stats.compiled);
+    printf("Arena: %lu words, %lu flushes\n", gx_list_stats.words_used, gx_list_stats.flushes);
+    printf("Skipped: %lu dyn, %lu 2D, %lu first, %lu clash\n", gx_list_stats.skipped[GX_SKIP_DYNAMIC],
+           gx_list_stats.skipped[GX_SKIP_2D], gx_list_stats.skipped[GX_SKIP_FIRST], gx_list_stats.skipped[GX_SKIP_CLASH]);
+#ifdef GX_LIST_VERIFY
+    // Report hit lists that differed from lowering their batch again
+    printf("GX verify: %lu/%lu differ\n", gx_list_stats.mismatches, gx_list_stats.verified);
+#endif
+    for (int i = 0; i < 0x100; i++) {
+        if (gx_list_stats.unsupported[i])
+            printf("Unsupported 0x%.2X: %lu\n", i, gx_list_stats.unsupported[i]);
+    }
+    gx_list_reset_stats();
+
+    // Report how texture binds were served, and how much was copied into VRAM
+    printf("Tex: %lu hit, %lu miss, %lu evict\n", texture_stats.hits, texture_stats.misses, texture_stats.evictions);
+    printf("     %lu defer, %lu repack, %lu KB\n", texture_stats.deferred, texture_stats.repacks, texture_stats.bytes_uploaded >> 10);
+    memset(&texture_stats, 0, sizeof(texture_stats));
+
+    // Report how many vertices were sent per frame, how many were saved by joining triangles into strips and quads,
+    // and how much geometry was dropped for being outside the view frustum
+    if (fps > 0) {
+        printf("Verts: %lu sent, %lu saved\n", vertex_stats.submitted / fps, vertex_stats.saved / fps);
+        printf("Culled: %lu chunks, %lu tris\n", vertex_stats.chunks_culled / fps, vertex_stats.tris_culled / fps);
+    }
+    memset(&vertex_stats, 0, sizeof(vertex_stats));
+
+    // Report how many animated limbs reused a pose from another object with the same animation and frame
+    printf("Pose: %u hit, %u miss\n", gPoseCacheStats.hits, gPoseCacheStats.misses);
+    memset(&gPoseCacheStats, 0, sizeof(gPoseCacheStats));
+
+    // Report how many behavior commands ran, and which one ran most often
+    u32 bhv_total = 0;
+    int bhv_top = 0;
+    for (int i = 0; i < BHV_CMD_COUNT; i++) {
+        bhv_total += gBhvCommandStats.counts[i];
+        if (gBhvCommandStats.counts[i] > gBhvCommandStats.counts[bhv_top])
+            bhv_top = i;
+    }
+    printf("Bhv: %u cmds, top 0x%.2X: %u\n", bhv_total, bhv_top, gBhvCommandStats.counts[bhv_top]);
+    memset(gBhvCommandStats.counts, 0, sizeof(gBhvCommandStats.counts));
+
+    // Report how many object surfaces were rebuilt, and how many were reused from the frame before
+    printf("Surf: %u rebuilt, %u reused\n", gDynamicSurfaceStats.rebuilt, gDynamicSurfaceStats.reused);
+    memset(&gDynamicSurfaceStats, 0, sizeof(gDynamicSurfaceStats));
+
+    // Report how many roomed objects were skipped for being in rooms that can't be seen from the current one
+    if (fps > 0)
+        printf("Rooms: %u objs hidden\n", gRoomVisibilityStats.hidden / fps);
+    memset(&gRoomVisibilityStats, 0, sizeof(gRoomVisibilityStats));
+
+    // Report how long building the Mario head took at boot, and how many object name lookups it made
+    printf("Head: %u us, %u lookups\n", (u32) (gGdmSetupTime * 1000000 / BUS_CLOCK), gDynObjLookupStats.lookups);
+
+    // Show how close the scene is to the polygon and vertex limits
+    budget_print();
+
+    // Reset the FPS counter
     fps = 0;
+
+#ifdef PROJECTION_VERIFY
+    // Report decal and 2D vertices where the single matrix setup disagreed with the per-vertex position test path,
+    // and culling clip matrices where the software copy disagreed with the geometry engine
+    printf("Projection: %lu/%lu differ\n", projection_verify.mismatches, projection_verify.vertices);
+    printf("Clip: %lu/%lu differ\n", projection_verify.matrix_mismatches, projection_verify.matrices);
+#endif
+
+#ifdef COLLISION_VERIFY
+    // Report collision queries where the fixed-point and float backends disagreed, and the last one's position
+    printf("Collision: %u/%u differ\n", gCollisionVerify.mismatches, gCollisionVerify.queries);
+    if (gCollisionVerify.mismatches) {
+        printf("  %c %d %d %d\n", gCollisionVerify.lastType, (int)gCollisionVerify.lastPos[0],
+               (int)gCollisionVerify.lastPos[1], (int)gCollisionVerify.lastPos[2]);
+    }
+#endif
+
+#ifdef OBJ_COLLISION_VERIFY
+    // Report frames where the object collision broadphase changed which objects collided
+    printf("Obj collision: %u/%u differ\n", gObjCollisionVerify.mismatches, gObjCollisionVerify.frames);
+#endif
+
+#ifdef DYNAMIC_SURFACE_VERIFY
+    // Report objects whose rebuilt surfaces differed from the ones that would have been reused
+    printf("Obj surfaces: %u differ, %u checked\n", gDynamicSurfaceVerify.mismatches, gDynamicSurfaceVerify.surfaces);
+#endif
+
+#ifdef DYNOBJ_INDEX_VERIFY
+    // Report head object name lookups where the index found something other than a linear scan would have
+    printf("Dynobj index: %u/%u differ\n", gDynObjLookupStats.mismatches, gDynObjLookupStats.lookups);
+#endif
+
+#ifdef STATIC_SURFACE_VERIFY
+    // Report static partition lists that came out in a different order than sorted insertion would give
+    printf("Static lists: %u/%u differ\n", gStaticSurfaceVerify.mismatches, gStaticSurfaceVerify.lists);
+#endif
+
+#ifdef GODDARD_SKIN_VERIFY
+    // Report skinned head vertices where the fixed-point and float backends disagreed, and the worst error
+    printf("Head skin: %u/%u differ, max %d/1000\n", gGdSkinVerify.mismatches, gGdSkinVerify.vertices,
+           (int)(gGdSkinVerify.maxError * 1000));
+#endif
 }
 
 int main(void) {
@@ -56,17 +218,20 @@ int main(void) {
     gEffectsMemoryPool = mem_pool_init(0x4000, MEMORY_POOL_LEFT);
 
     // Initialize various components
+    profiler_timer_init();
     fatInitDefault();
+    segments_init();
     renderer_init();
     audio_init();
     sound_init();
 
-    // Set up audio on the ARM9 side
-    irqSet(IRQ_IPC_SYNC, update_audio);
-    irqEnable(IRQ_IPC_SYNC);
+    // Write back anything cached for the audio ring, then give the ARM7 a pointer to it
+    DC_FlushRange(&audio_ring_data, sizeof(audio_ring_data));
+    audio_ring = memUncached(&audio_ring_data);
+    fifoSendValue32(FIFO_USER_01, (u32)audio_ring);
 
-    // Give the ARM7 a pointer to the audio data
-    fifoSendValue32(FIFO_USER_01, (u32)gNotes);
+    // Update audio on the ARM9 side; the period is exactly a batch of the ARM7's ticks, so the ring doesn't drift
+    timerStart(1, ClockDivider_64, TIMER_FREQ_64(AUDIO_TICK_RATE) * AUDIO_TICKS_PER_BATCH, update_audio);
 
 #ifdef ENABLE_FPS
     // Update the FPS counter every second
@@ -0,0 +1,55 @@
+#ifndef NDS_AUDIO_RING_H
+#define NDS_AUDIO_RING_H
+
+#include "audio/internal.h"
+
+// Sequences and notes are still processed on the ARM9, in batches from a timer interrupt; only the resulting channel
+// states are passed to the ARM7, through a single-producer, single-consumer ring in uncached main RAM
+// The ARM7 plays one state per tick from its own timer, so neither CPU ever waits on the other, but the sequencing
+// time is still taken from the ARM9; running the sequence player on the ARM7 would need it and the sound banks to
+// fit beside the ARM7 code, which this doesn't attempt
+// The ring holds two batches, so the ARM7 plays notes at most 33 ms after they were sequenced
+#define AUDIO_TICK_RATE 240
+#define AUDIO_TICKS_PER_BATCH 4
+#define AUDIO_RING_SIZE 8 // Must be a power of 2
+
+struct AudioChannelState {
+    const struct AudioBankSample *sample; // NULL if the channel should be stopped
+    f32 frequency;
+    u16 volLeft;
+    u16 volRight;
+    bool init;
+};
+
+struct AudioTick {
+    struct AudioChannelState channels[16];
+};
+
+struct AudioRing {
+    volatile u32 head; // Only written by the ARM9
+    volatile u32 tail; // Only written by the ARM7
+    struct AudioTick ticks[AUDIO_RING_SIZE];
+};
+
+static inline u32 audio_ring_count(const struct AudioRing *ring) {
+    return ring->head - ring->tail;
+}
+
+static inline struct AudioTick *audio_ring_write_slot(struct AudioRing *ring) {
+    return &ring->ticks[ring->head & (AUDIO_RING_SIZE - 1)];
+}
+
+static inline void audio_ring_push(struct AudioRing *ring) {
+    // The slot is fully written before this, so the ARM7 never sees a partial tick
+    ring->head++;
+}
+
+static inline const struct AudioTick *audio_ring_read_slot(const struct AudioRing *ring) {
+    return &ring->ticks[ring->tail & (AUDIO_RING_SIZE - 1)];
+}
+
+static inline void audio_ring_pop(struct AudioRing *ring) {
+    ring->tail++;
+}
+
+#endif // NDS_AUDIO_RING_H
@@ -0,0 +1,110 @@
+#include <stdio.h>
+
+#include "nds_include.h"
+
+#include "nds_budget.h"
+#include "game/rendering_graph_node.h"
+
+// The geometry engine silently drops polygons past these limits, so the polygon and vertex RAM usage of each frame
+// is tracked, and the level of detail and object draw distances are adjusted to keep the recent peak below them
+#define POLYGON_LIMIT 2048
+#define VERTEX_LIMIT 6144
+#define HISTORY_SIZE 16 // Must be a power of 2
+
+// Usage thresholds in 1/256 of the limits; detail is reduced quickly above the high mark, and restored slowly below the low one
+#define USAGE_HIGH 230
+#define USAGE_LOW 192
+
+// Level of detail distance scale in 1/16 units, up to 3x
+#define SCALE_MIN 16
+#define SCALE_MAX 48
+
+// Per-frame usage is appended to a file on SD when full if GEOMETRY_LOG is defined
+#define RECORD_COUNT 256
+
+struct BudgetRecord {
+    uint16_t polygons;
+    uint16_t vertices;
+    uint16_t scale;
+};
+
+static struct BudgetRecord history[HISTORY_SIZE];
+static uint32_t history_index;
+static uint32_t overflows;
+
+#ifdef GEOMETRY_LOG
+static struct BudgetRecord records[RECORD_COUNT];
+static uint16_t record_count;
+
+static void dump_records() {
+    // Append the collected frames to a file on SD
+    FILE *fp = fopen("sm64_geometry.csv", "a");
+    if (fp != NULL) {
+        for (int i = 0; i < record_count; i++)
+            fprintf(fp, "%u,%u,%u\n", records[i].polygons, records[i].vertices, records[i].scale);
+        fclose(fp);
+    }
+    record_count = 0;
+}
+#endif
+
+void budget_update() {
+    // Let the geometry engine finish the commands still queued in the FIFO, so the counters cover the whole frame
+    // They're reset when the buffers swap, so this has to happen before the flush; they stop at the limits if they overflow
+    while (GFX_BUSY);
+
+    // Read the RAM usage of the frame that's about to be flushed
+    struct BudgetRecord *cur = &history[history_index++ & (HISTORY_SIZE - 1)];
+    cur->polygons = GFX_POLYGON_RAM_USAGE;
+    cur->vertices = GFX_VERTEX_RAM_USAGE;
+    cur->scale = gLodDistanceScale;
+
+#ifdef GEOMETRY_LOG
+    records[record_count++] = *cur;
+    if (record_count == RECORD_COUNT)
+        dump_records();
+#endif
+
+    // Get the peak usage over the recent frames, relative to whichever limit is closer
+    uint32_t peak = 0;
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        const uint32_t polygons = history[i].polygons * 256 / POLYGON_LIMIT;
+        const uint32_t vertices = history[i].vertices * 256 / VERTEX_LIMIT;
+        if (polygons > peak) peak = polygons;
+        if (vertices > peak) peak = vertices;
+    }
+
+    // Reduce detail right away if geometry was dropped this frame
+    int scale = gLodDistanceScale;
+    if (cur->polygons >= POLYGON_LIMIT || cur->vertices >= VERTEX_LIMIT) {
+        overflows++;
+        scale += 8;
+    } else if (peak > USAGE_HIGH) {
+        scale += 2;
+    } else if (peak < USAGE_LOW) {
+        scale -= 1;
+    }
+
+    if (scale < SCALE_MIN) scale = SCALE_MIN;
+    if (scale > SCALE_MAX) scale = SCALE_MAX;
+
+    // Feed the budget back into the scene graph for the next frame
+    gLodDistanceScale = scale;
+    gObjCullDistance = 20000.0f * SCALE_MIN / scale;
+}
+
+void budget_print() {
+    // Print the last frame's usage and the recent peak, and how far detail has been reduced
+    const struct BudgetRecord *cur = &history[(history_index - 1) & (HISTORY_SIZE - 1)];
+    uint16_t peak_polygons = 0;
+    uint16_t peak_vertices = 0;
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        if (history[i].polygons > peak_polygons) peak_polygons = history[i].polygons;
+        if (history[i].vertices > peak_vertices) peak_vertices = history[i].vertices;
+    }
+
+    printf("Poly: %4u peak %4u/%d\n", cur->polygons, peak_polygons, POLYGON_LIMIT);
+    printf("Vert: %4u peak %4u/%d\n", cur->vertices, peak_vertices, VERTEX_LIMIT);
+    printf("LOD: x%d.%02d, %lu overflows\n", gLodDistanceScale / 16, (gLodDistanceScale % 16) * 100 / 16,
+           (unsigned long)overflows);
+}
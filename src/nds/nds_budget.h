@@ -0,0 +1,7 @@
+#ifndef NDS_BUDGET_H
+#define NDS_BUDGET_H
+
+extern void budget_update();
+extern void budget_print();
+
+#endif // NDS_BUDGET_H
@@ -0,0 +1,217 @@
+#include <string.h>
+
+#include "nds_include.h"
+
+#include "nds_gx_list.h"
+
+// Static vertex batches are lowered into packed GX command lists, so the next time the same batch is drawn
+// it can be sent to the geometry FIFO with a single DMA instead of being decoded and written word by word
+// Batches are keyed by a hash of their final vertex contents and the texture state used to generate them, and each
+// compiled list keeps a copy of that source, so a batch that only shares the hash isn't drawn with the wrong list
+
+#define LIST_ARENA_SIZE (0x40000 / sizeof(uint32_t))
+#define LIST_TABLE_SIZE 2048
+#define LIST_TABLE_LIMIT (LIST_TABLE_SIZE * 3 / 4)
+#define LIST_SOURCE_WORDS(count) (2 + (count) * 4)
+#define LIST_VERIFY_SIZE 1024
+
+// Marks a batch that has been seen once, but hasn't been compiled yet
+#define LIST_SEEN ((uint32_t*)1)
+
+struct ListEntry {
+    uint32_t key;
+    uint32_t *list;
+    uint32_t *source; // Stored in the arena in front of the list
+    uint16_t count;
+    uint16_t vertices;
+};
+
+struct GxListStats gx_list_stats;
+
+static uint32_t list_arena[LIST_ARENA_SIZE] __attribute__((aligned(32)));
+static uint32_t list_arena_used;
+
+static struct ListEntry list_table[LIST_TABLE_SIZE];
+static uint16_t list_table_used;
+
+DTCM_BSS static struct ListEntry *list_current;
+DTCM_BSS static uint32_t *list_start;
+DTCM_BSS static uint32_t *list_pack;
+DTCM_BSS static uint32_t *list_write;
+DTCM_BSS static uint8_t list_slot;
+
+#ifdef GX_LIST_VERIFY
+static uint32_t list_verify[LIST_VERIFY_SIZE];
+#endif
+
+static void gx_list_flush() {
+    // Forget all compiled lists; lists that were already sent have been fully consumed by DMA
+    memset(list_table, 0, sizeof(list_table));
+    list_table_used = 0;
+    list_arena_used = 0;
+    gx_list_stats.flushes++;
+}
+
+ITCM_CODE static struct ListEntry *find_entry(uint32_t key) {
+    // Look up a batch using its key as the hash
+    uint32_t index = key & (LIST_TABLE_SIZE - 1);
+    while (list_table[index].key != key && list_table[index].key != 0) {
+        index = (index + 1) & (LIST_TABLE_SIZE - 1);
+    }
+    return &list_table[index];
+}
+
+ITCM_CODE static bool source_matches(const struct ListEntry *entry, const struct GxListSource *source) {
+    // Compare the whole source of the batch, since different batches can hash to the same key
+    const uint32_t *stored = entry->source;
+    if (entry->count != source->count || stored[0] != source->state[0] || stored[1] != source->state[1])
+        return false;
+
+    stored += 2;
+    for (int i = 0; i < source->count; i++, stored += 4) {
+        const uint32_t *w = source->vertices[i];
+        if (stored[0] != w[0] || stored[1] != w[1] || stored[2] != w[2] || stored[3] != w[3])
+            return false;
+    }
+    return true;
+}
+
+ITCM_CODE const uint32_t *gx_list_lookup(uint32_t key, const struct GxListSource *source, bool *compile, uint32_t *vertices) {
+    // Keys of 0 are used for empty entries
+    key |= 1;
+
+    struct ListEntry *entry = find_entry(key);
+
+    // Return the compiled list if there is one, or draw the batch directly if the key belongs to another one
+    if (entry->key == key && entry->list != LIST_SEEN) {
+        *compile = false;
+        if (!source_matches(entry, source)) {
+            gx_list_stats.skipped[GX_SKIP_CLASH]++;
+            return NULL;
+        }
+        gx_list_stats.hits++;
+        *vertices = entry->vertices;
+        return entry->list;
+    }
+
+    // Only compile batches once they're seen a second time, so one-off geometry doesn't fill the arena
+    if (entry->key == key) {
+        list_current = entry;
+        *compile = true;
+        return NULL;
+    }
+
+    if (list_table_used >= LIST_TABLE_LIMIT) {
+        gx_list_flush();
+        entry = find_entry(key);
+    }
+
+    entry->key = key;
+    entry->list = LIST_SEEN;
+    list_table_used++;
+    gx_list_stats.skipped[GX_SKIP_FIRST]++;
+    *compile = false;
+    return NULL;
+}
+
+ITCM_CODE static void gx_list_command(uint8_t command) {
+    // Start a new command pack every 4 commands; unused slots are left as NOPs
+    if (list_slot == 4) {
+        list_pack = list_write++;
+        *list_pack = 0;
+        list_slot = 0;
+    }
+    *list_pack |= command << (list_slot++ * 8);
+}
+
+void gx_list_begin(uint32_t key, const struct GxListSource *source) {
+    // Make sure the source and a worst-case list fit (1 pack word per 4 commands, plus 4 parameter words per
+    // vertex, plus a begin command for every triangle if none of them could be joined)
+    const int count = source->count;
+    const uint32_t needed = LIST_SOURCE_WORDS(count) + count * 6 + 2;
+    if (list_arena_used + needed > LIST_ARENA_SIZE) {
+        gx_list_flush();
+
+        // The entry being compiled was cleared by the flush, so add it back
+        key |= 1;
+        list_current = find_entry(key);
+        list_current->key = key;
+        list_table_used++;
+    }
+
+    // Keep a copy of the source to compare against when the key comes up again
+    uint32_t *stored = &list_arena[list_arena_used];
+    list_current->source = stored;
+    list_current->count = count;
+    *stored++ = source->state[0];
+    *stored++ = source->state[1];
+    for (int i = 0; i < count; i++, stored += 4)
+        memcpy(stored, source->vertices[i], 4 * sizeof(uint32_t));
+    list_arena_used += LIST_SOURCE_WORDS(count);
+
+    list_start = &list_arena[list_arena_used];
+    list_write = list_start + 1;
+    list_slot = 4;
+}
+
+#ifdef GX_LIST_VERIFY
+bool gx_list_verify_begin(int count) {
+    // Lower a batch that hit a compiled list again, into scratch space, so the two can be compared
+    if (count * 6 + 2 > LIST_VERIFY_SIZE)
+        return false;
+    list_start = list_verify;
+    list_write = list_start + 1;
+    list_slot = 4;
+    return true;
+}
+
+void gx_list_verify_end(const uint32_t *list) {
+    // The list that was hit should be exactly what lowering the batch now gives
+    const uint32_t size = list_write - list_start;
+    list_verify[0] = size - 1;
+    gx_list_stats.verified++;
+    if (list[0] != size - 1 || memcmp(list, list_verify, size * sizeof(uint32_t)))
+        gx_list_stats.mismatches++;
+}
+#endif
+
+ITCM_CODE void gx_list_primitive(int type) {
+    gx_list_command(FIFO_BEGIN);
+    *list_write++ = type;
+}
+
+ITCM_CODE void gx_list_color(uint8_t r, uint8_t g, uint8_t b) {
+    gx_list_command(FIFO_COLOR);
+    *list_write++ = RGB15(r >> 3, g >> 3, b >> 3);
+}
+
+ITCM_CODE void gx_list_texcoord(int16_t s, int16_t t) {
+    gx_list_command(FIFO_TEX_COORD);
+    *list_write++ = TEXTURE_PACK(s, t);
+}
+
+ITCM_CODE void gx_list_vertex(int16_t x, int16_t y, int16_t z) {
+    gx_list_command(FIFO_VERTEX16);
+    *list_write++ = VERTEX_PACK(x, y);
+    *list_write++ = VERTEX_PACK(z, 0);
+}
+
+const uint32_t *gx_list_end(uint32_t vertices) {
+    // Store the list size in front of the list, as expected by glCallList
+    const uint32_t size = list_write - list_start;
+    *list_start = size - 1;
+    list_arena_used += size;
+
+    list_current->list = list_start;
+    list_current->vertices = vertices;
+    gx_list_stats.compiled++;
+    gx_list_stats.words_used = list_arena_used;
+    return list_start;
+}
+
+void gx_list_reset_stats() {
+    // Clear the per-interval counters, keeping the arena usage
+    const uint32_t words_used = gx_list_stats.words_used;
+    memset(&gx_list_stats, 0, sizeof(gx_list_stats));
+    gx_list_stats.words_used = words_used;
+}
@@ -0,0 +1,50 @@
+#ifndef NDS_GX_LIST_H
+#define NDS_GX_LIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum GxListSkip {
+    GX_SKIP_DYNAMIC, // Vertices came from the per-frame display list pool
+    GX_SKIP_2D,      // Non-Z-buffered vertices need their depth changed between triangles
+    GX_SKIP_FIRST,   // Batch hasn't been seen before, so it isn't worth compiling yet
+    GX_SKIP_CLASH,   // Batch has the same key as a different compiled one
+    GX_SKIP_MAX
+};
+
+struct GxListStats {
+    uint32_t hits;
+    uint32_t compiled;
+    uint32_t flushes;
+    uint32_t words_used;
+    uint32_t skipped[GX_SKIP_MAX];
+    uint32_t unsupported[0x100];
+#ifdef GX_LIST_VERIFY
+    uint32_t verified;
+    uint32_t mismatches;
+#endif
+};
+
+extern struct GxListStats gx_list_stats;
+
+// A batch's source is the render state that affects its commands, and the 4 words of each final vertex
+struct GxListSource {
+    uint32_t state[2];
+    const uint32_t *const *vertices;
+    int count;
+};
+
+extern const uint32_t *gx_list_lookup(uint32_t key, const struct GxListSource *source, bool *compile, uint32_t *vertices);
+extern void gx_list_begin(uint32_t key, const struct GxListSource *source);
+extern void gx_list_primitive(int type);
+extern void gx_list_color(uint8_t r, uint8_t g, uint8_t b);
+extern void gx_list_texcoord(int16_t s, int16_t t);
+extern void gx_list_vertex(int16_t x, int16_t y, int16_t z);
+extern const uint32_t *gx_list_end(uint32_t vertices);
+#ifdef GX_LIST_VERIFY
+extern bool gx_list_verify_begin(int count);
+extern void gx_list_verify_end(const uint32_t *list);
+#endif
+extern void gx_list_reset_stats();
+
+#endif // NDS_GX_LIST_H
@@ -0,0 +1,142 @@
+#include <stdio.h>
+
+#include "nds_include.h"
+
+#include "nds_profiler.h"
+#include "game/object_list_processor.h"
+
+// Timers 2 and 3 are cascaded into a 32-bit counter running at the bus clock, and overflows of that are
+// counted in software to extend it to 64 bits (it overflows about every 128 seconds)
+#define TIMER_LOW  2
+#define TIMER_HIGH 3
+
+// Per-frame phase times are collected here, and appended to a file on SD when full if PROFILE_DUMP is defined
+#define RECORD_COUNT 256
+
+struct FrameRecord {
+    uint32_t cycles[PHASE_COUNT];
+};
+
+static volatile uint32_t timer_overflows;
+
+DTCM_BSS static enum ProfilerPhase cur_phase;
+DTCM_BSS static uint64_t phase_start;
+DTCM_BSS static uint64_t audio_start;
+DTCM_BSS static uint32_t audio_total;
+DTCM_BSS static uint32_t audio_at_phase_start;
+
+static struct FrameRecord frame;
+static uint64_t frame_sums[PHASE_COUNT];
+static uint32_t frame_sum_count;
+
+#ifdef PROFILE_DUMP
+static struct FrameRecord records[RECORD_COUNT];
+static uint16_t record_count;
+#endif
+
+static void timer_overflow() {
+    timer_overflows++;
+}
+
+void profiler_timer_init() {
+    // Start the high timer first, so it's already counting when the low timer starts overflowing into it
+    TIMER_DATA(TIMER_HIGH) = 0;
+    TIMER_CR(TIMER_HIGH) = TIMER_ENABLE | TIMER_CASCADE | TIMER_IRQ_REQ;
+    TIMER_DATA(TIMER_LOW) = 0;
+    TIMER_CR(TIMER_LOW) = TIMER_ENABLE | TIMER_DIV_1;
+
+    irqSet(IRQ_TIMER(TIMER_HIGH), timer_overflow);
+    irqEnable(IRQ_TIMER(TIMER_HIGH));
+}
+
+ITCM_CODE uint64_t profiler_timer_read() {
+    uint32_t high, low, overflows;
+
+    // Read the timers until the high half doesn't change in between, so both halves match
+    do {
+        overflows = timer_overflows;
+        high = TIMER_DATA(TIMER_HIGH);
+        low = TIMER_DATA(TIMER_LOW);
+    } while (high != TIMER_DATA(TIMER_HIGH) || overflows != timer_overflows);
+
+    // If this is called with interrupts blocked, an overflow may be pending that hasn't been counted yet
+    const uint32_t count = (high << 16) | low;
+    if ((REG_IF & IRQ_TIMER(TIMER_HIGH)) && count < 0x80000000)
+        overflows++;
+
+    return ((uint64_t)overflows << 32) | count;
+}
+
+#ifdef PROFILE_DUMP
+static void dump_records() {
+    // Append the collected frames to a file on SD, in microseconds
+    FILE *fp = fopen("sm64_profile.csv", "a");
+    if (fp != NULL) {
+        for (int i = 0; i < record_count; i++) {
+            for (int j = 0; j < PHASE_COUNT; j++)
+                fprintf(fp, (j < PHASE_COUNT - 1) ? "%lu," : "%lu\n", (uint32_t)((uint64_t)records[i].cycles[j] * 1000000 / BUS_CLOCK));
+        }
+        fclose(fp);
+    }
+    record_count = 0;
+}
+#endif
+
+static void end_frame_record() {
+    // Add the frame to the running totals used for the on-screen averages
+    for (int i = 0; i < PHASE_COUNT; i++)
+        frame_sums[i] += frame.cycles[i];
+    frame_sum_count++;
+
+#ifdef PROFILE_DUMP
+    records[record_count++] = frame;
+    if (record_count == RECORD_COUNT)
+        dump_records();
+#endif
+
+    for (int i = 0; i < PHASE_COUNT; i++)
+        frame.cycles[i] = 0;
+}
+
+ITCM_CODE void profiler_switch_phase(enum ProfilerPhase phase) {
+    const uint64_t now = profiler_timer_read();
+
+    // Attribute the time since the last switch to the current phase, minus time spent in audio interrupts
+    const uint32_t audio = audio_total - audio_at_phase_start;
+    frame.cycles[cur_phase] += (uint32_t)(now - phase_start) - audio;
+    frame.cycles[PHASE_AUDIO] += audio;
+
+    // Switching back to game logic marks the end of a frame
+    if (phase == PHASE_GAME)
+        end_frame_record();
+
+    cur_phase = phase;
+    phase_start = now;
+    audio_at_phase_start = audio_total;
+}
+
+ITCM_CODE void profiler_audio_begin() {
+    audio_start = profiler_timer_read();
+}
+
+ITCM_CODE void profiler_audio_end() {
+    audio_total += (uint32_t)(profiler_timer_read() - audio_start);
+}
+
+void profiler_print() {
+    // Print the average time of each phase since the last call, in microseconds
+    static const char *names[PHASE_COUNT] = { "Game", "Render", "Wait", "Audio" };
+    if (frame_sum_count == 0) return;
+
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        printf("%-7s%6lu us\n", names[i], (uint32_t)(frame_sums[i] * 1000000 / BUS_CLOCK / frame_sum_count));
+        frame_sums[i] = 0;
+    }
+    frame_sum_count = 0;
+
+    // Print the last frame's object update breakdown: dynamic surfaces, terrain objects, collisions, other objects
+    printf("Obj:");
+    for (int i = 2; i < 6; i++)
+        printf(" %lu", (uint32_t)((gObjectUpdateCycles[i] - gObjectUpdateCycles[i - 1]) * 1000000 / BUS_CLOCK));
+    printf(" us\n");
+}
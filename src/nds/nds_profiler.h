@@ -0,0 +1,21 @@
+#ifndef NDS_PROFILER_H
+#define NDS_PROFILER_H
+
+#include <stdint.h>
+
+enum ProfilerPhase {
+    PHASE_GAME,   // Game logic, from the end of one frame to the start of the next draw
+    PHASE_RENDER, // Interpreting the display list and sending it to the 3D engine
+    PHASE_WAIT,   // Waiting for V-blank after glFlush
+    PHASE_AUDIO,  // Audio updates in the timer interrupt, subtracted from whichever phase they interrupted
+    PHASE_COUNT
+};
+
+extern void profiler_timer_init();
+extern uint64_t profiler_timer_read();
+extern void profiler_switch_phase(enum ProfilerPhase phase);
+extern void profiler_audio_begin();
+extern void profiler_audio_end();
+extern void profiler_print();
+
+#endif // NDS_PROFILER_H
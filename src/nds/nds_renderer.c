@@ -1,10 +1,18 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <PR/gbi.h>
 
 #include "nds_include.h"
 #include <nds/arm9/postest.h>
 
 #include "nds_renderer.h"
+#include "nds_gx_list.h"
+#include "nds_budget.h"
+#include "nds_profiler.h"
+#include "nds_skybox.h"
+#include "nds_trace.h"
+#include "game/game_init.h"
+#include "game/profiler.h"
 #include "c_button.h"
 #include "stick.h"
 #include "stick_base_1.h"
@@ -12,16 +20,28 @@
 
 #define BATCH_SIZE 96
 
+// Textures with few enough colors are converted to paletted formats at compile time, and start with this header
+// The magic includes a version, and is followed by the total size, which has to match the format stored after it
+#define TEXTURE_MAGIC 0x3158544E // "NTX1"
+#define TEXTURE_HEADER_WORDS 3
+
 struct Color {
     uint8_t r, g, b, a;
 };
 
 struct Texture {
     uint8_t *address;
+    const uint8_t *data;
+    const uint16_t *palette;
     int name;
+    uint32_t last_used;
+    uint32_t pal_index;
+    uint16_t pal_addr;
+    uint16_t pal_count;
     uint8_t type;
     uint8_t size_x;
     uint8_t size_y;
+    bool transparent;
 };
 
 struct Light {
@@ -35,14 +55,32 @@ DTCM_BSS static struct Color fog_color;
 DTCM_BSS static struct Color env_color;
 
 DTCM_BSS static Vtx vertex_buffer[16];
+DTCM_BSS static uint32_t vertex_hash[16];
+
+// Each vertex load is treated as a chunk, and its bounding box is tested against the view frustum
+// Every loaded vertex gets the frustum planes its whole chunk lies outside of, so triangles whose vertices share one
+// are dropped before they're batched; the matrices are mirrored in software so the combined matrix can be rebuilt
+// without reading it back from the geometry engine, which would wait for every queued command to finish
+DTCM_BSS static uint8_t vertex_outcode[16];
+DTCM_BSS static m4x4 cull_clip;
+DTCM_BSS static bool cull_clip_valid;
+DTCM_BSS static m4x4 cull_projection;
+DTCM_BSS static m4x4 cull_modelview;
+static m4x4 cull_stack[31];
+static uint8_t cull_depth;
 static struct Texture texture_map[2048];
 DTCM_BSS static struct Light lights[5];
 
-static uint16_t texture_fifo[2048];
-static uint16_t texture_fifo_start;
-static uint16_t texture_fifo_end;
+static uint16_t resident[2048];
+static uint16_t resident_count;
+static uint32_t resident_bytes;
+static uint32_t upload_bytes;
+static bool repack_pending;
+
+struct TextureStats texture_stats;
 
 static uint8_t *texture_address;
+DTCM_BSS static struct Texture *bound_texture;
 DTCM_BSS static uint8_t texture_format;
 DTCM_BSS static uint8_t texture_bit_width;
 DTCM_BSS static uint16_t texture_row_size;
@@ -66,6 +104,7 @@ DTCM_BSS static int num_lights;
 DTCM_BSS static int polygon_id;
 DTCM_BSS static int poly_fmt;
 DTCM_BSS static int tex_params;
+DTCM_BSS static int tex_transparency;
 
 DTCM_BSS static bool use_color;
 DTCM_BSS static bool use_texture;
@@ -82,10 +121,25 @@ DTCM_BSS static uint16_t fog_max;
 
 DTCM_BSS static int no_texture;
 DTCM_BSS static int frame_count;
+DTCM_BSS static uint32_t texture_frame;
 
 DTCM_BSS static Vtx_t *vertex_batch[BATCH_SIZE];
 DTCM_BSS static uint8_t batch_count;
 
+// Triangles in a batch are joined into strips and quads where they share edges
+struct PrimitiveRun {
+    uint8_t type;
+    uint8_t start;
+    uint8_t count;
+};
+
+DTCM_BSS static const Vtx_t *prim_vertices[BATCH_SIZE];
+DTCM_BSS static struct PrimitiveRun prim_runs[BATCH_SIZE / 3];
+
+struct VertexStats vertex_stats;
+
+DTCM_BSS static const uint8_t *dynamic_start;
+
 // SM64 code needs these, but we're not actually including the fast3d microcode bins
 u64 rspF3DStart[] = {};
 u64 rspF3DBootStart[] = {};
@@ -99,9 +153,19 @@ struct {
     gl_texture_data *tex;
 } glTexQueue[128];
 
+struct {
+    const void *palette;
+    void *dest;
+    uint32_t size;
+} glPalQueue[128];
+
 static uint8_t glTexCount;
+static uint8_t glPalCount;
 static void glTexSync();
 
+// The number of bits per pixel for each DS texture format
+static const uint8_t type_bits[8] = { 0, 8, 2, 4, 8, 2, 8, 16 };
+
 // This is a modified (and simplified) version of glTexImage2D from libnds
 // The original updates texture VRAM right away, which causes tearing when done mid-frame
 // This adds textures to a queue, so VRAM will only be updated when glTexSync is called
@@ -109,22 +173,18 @@ static int glTexImage2DAsync(int target, int empty1, GL_TEXTURE_TYPE_ENUM type,
     if (!glGlob->activeTexture)
         return 0;
 
-    uint32_t size = 1 << (sizeX + sizeY + 6);
-    uint32_t typeSizes[9] = { 0, 8, 2, 4, 8, 3, 8, 16, 16 }; // Represents the number of bits per pixels for each format
-
-    if (type == GL_RGBA)
-        size <<= 1;
-    else if (type == GL_NOTEXTURE)
-        size = 0;
-    else if (type != GL_RGB8_A5)
+    // Compressed textures need their index data placed in a matching spot in slot 1, which isn't handled here
+    if (type == GL_COMPRESSED)
         return 0;
 
+    uint32_t size = (1 << (sizeX + sizeY + 6)) * type_bits[type] / 8;
+
     gl_texture_data *tex = (gl_texture_data*)DynamicArrayGet(&glGlob->texturePtrs, glGlob->activeTexture);
 
     // Clear out the texture data if one already exists for the active texture
     if (tex) {
         uint32_t texType = ((tex->texFormat >> 26) & 0x07);
-        if ((tex->texSize != size) || (typeSizes[texType] != typeSizes[type])) {
+        if ((tex->texSize != size) || (type_bits[texType] != type_bits[type])) {
             if(tex->texIndexExt)
                 vramBlock_deallocateBlock(glGlob->vramBlocks[0], tex->texIndexExt);
             if(tex->texIndex)
@@ -168,7 +228,43 @@ static int glTexImage2DAsync(int target, int empty1, GL_TEXTURE_TYPE_ENUM type,
     return 1;
 }
 
+// Allocates space for a texture palette and queues it to be copied, like glTexImage2DAsync does for textures
+// Returns the VRAM block index, or 0 if there wasn't room; the value for GFX_PAL_FORMAT is written to addr
+static uint32_t glColorTableAsync(int type, const uint16_t *palette, int count, uint16_t *addr) {
+    // 4-color palettes only need to be aligned to 8 bytes, others to 16
+    const uint32_t size = ((count * 2) + 3) & ~3;
+    const int shift = (type == GL_RGB4) ? 3 : 4;
+    const uint32_t index = vramBlock_allocateBlock(glGlob->vramBlocks[1], size, shift);
+    if (!index)
+        return 0;
+
+    void *dest = vramBlock_getAddr(glGlob->vramBlocks[1], index);
+    *addr = ((uint32_t)dest - (uint32_t)VRAM_E) >> shift;
+
+    // Queue palette data to be copied into VRAM
+    if (glPalCount == 128)
+        glTexSync();
+
+    glPalQueue[glPalCount].palette = palette;
+    glPalQueue[glPalCount].dest = dest;
+    glPalQueue[glPalCount].size = size;
+    glPalCount++;
+
+    return index;
+}
+
 static void glTexSync() {
+    // Copy all queued palette data into VRAM
+    if (glPalCount > 0) {
+        vramSetBankE(VRAM_E_LCD);
+        for (size_t i = 0; i < glPalCount; i++) {
+            dmaCopyWords(0, glPalQueue[i].palette, glPalQueue[i].dest, glPalQueue[i].size);
+            texture_stats.bytes_uploaded += glPalQueue[i].size;
+        }
+        vramSetBankE(VRAM_E_TEX_PALETTE);
+        glPalCount = 0;
+    }
+
     // Copy all queued texture data into VRAM
     for (size_t i = 0; i < glTexCount; i++) {
         const void *texture = glTexQueue[i].texture;
@@ -191,11 +287,168 @@ static void glTexSync() {
         } while (startBank <= endBank);
 
         dmaCopyWords(0, texture, tex->vramAddr, tex->texSize);
+        texture_stats.bytes_uploaded += tex->texSize;
 
         vramRestorePrimaryBanks(vramTemp);
     }
 
     glTexCount = 0;
+    upload_bytes = 0;
+}
+
+static uint32_t texture_bytes(struct Texture *tex) {
+    // Get the size of a texture in VRAM, not counting its palette
+    return (1 << (tex->size_x + tex->size_y + 6)) * type_bits[tex->type] / 8;
+}
+
+static uint32_t texture_load_bytes(struct Texture *tex) {
+    // Get the number of bytes copied into VRAM to load a texture, including its palette
+    return texture_bytes(tex) + (tex->palette ? tex->pal_count * 2 : 0);
+}
+
+static void remove_texture(uint32_t slot) {
+    // Push a texture out of VRAM, along with its palette
+    struct Texture *old = &texture_map[resident[slot]];
+    resident_bytes -= texture_bytes(old);
+    glDeleteTextures(1, &old->name);
+    old->name = 0;
+    if (old == bound_texture)
+        bound_texture = NULL;
+    if (old->pal_index) {
+        vramBlock_deallocateBlock(glGlob->vramBlocks[1], old->pal_index);
+        old->pal_index = 0;
+    }
+
+    // Fill the gap in the resident list with the last entry
+    resident[slot] = resident[--resident_count];
+    texture_stats.evictions++;
+}
+
+static bool evict_texture() {
+    // Find the least recently used texture; ones used this frame are skipped, since they're still needed in VRAM
+    int oldest = -1;
+    for (int i = 0; i < resident_count; i++) {
+        const uint32_t last_used = texture_map[resident[i]].last_used;
+        if (last_used != texture_frame && (oldest < 0 || last_used < texture_map[resident[oldest]].last_used))
+            oldest = i;
+    }
+
+    if (oldest < 0)
+        return false;
+
+    remove_texture(oldest);
+    return true;
+}
+
+static void repack_textures() {
+    // Free all textures that weren't used in the last frame at once, so the gaps between them merge into larger blocks
+    // Textures still in use aren't moved, since that would mean copying them again
+    for (int i = resident_count - 1; i >= 0; i--) {
+        if (texture_map[resident[i]].last_used + 1 < texture_frame)
+            remove_texture(i);
+    }
+    repack_pending = false;
+    texture_stats.repacks++;
+}
+
+static void bind_texture(struct Texture *cur) {
+    // Bind a texture and its palette; textures without their own palette use the IA palette at the start of palette VRAM
+    // Nothing needs to be sent if it's still bound, like when text is drawn from one glyph texture
+    if (cur != bound_texture) {
+        glBindTexture(GL_TEXTURE_2D, cur->name);
+        GFX_PAL_FORMAT = cur->pal_addr;
+        bound_texture = cur;
+    }
+    tex_transparency = cur->transparent ? GL_TEXTURE_COLOR0_TRANSPARENT : 0;
+    cur->last_used = texture_frame;
+}
+
+static void defer_texture() {
+    // Draw without a texture until there's room to upload it on a later frame
+    glBindTexture(GL_TEXTURE_2D, no_texture);
+    bound_texture = NULL;
+    tex_transparency = 0;
+    texture_stats.deferred++;
+}
+
+static void upload_texture(uint32_t index) {
+    struct Texture *cur = &texture_map[index];
+    const uint32_t size = texture_bytes(cur);
+    const uint32_t bytes = texture_load_bytes(cur);
+
+#ifdef TARGET_HOST
+    residency_record(cur->address, bytes);
+#endif
+
+    // Defer the texture if it would go over this V-blank's upload budget; a texture is always allowed when nothing else is queued
+    if ((upload_bytes > 0 && upload_bytes + bytes > UPLOAD_BUDGET) || glTexCount == 128 || glPalCount == 128) {
+        defer_texture();
+        return;
+    }
+
+    // Allocate the palette first, so nothing is left in the texture queue if allocation fails
+    // Evict the least recently used textures until there's room
+    if (cur->palette) {
+        while (!(cur->pal_index = glColorTableAsync(cur->type, cur->palette, cur->pal_count, &cur->pal_addr))) {
+            if (!evict_texture()) {
+                defer_texture();
+                return;
+            }
+        }
+    }
+
+    glGenTextures(1, &cur->name);
+    glBindTexture(GL_TEXTURE_2D, cur->name);
+    bound_texture = NULL;
+    while (!glTexImage2DAsync(GL_TEXTURE_2D, 0, cur->type, cur->size_x, cur->size_y, 0, TEXGEN_TEXCOORD, cur->data)) {
+        // Failing with enough free space in total means VRAM is fragmented, so clear it out at the start of the next frame
+        if (resident_bytes + size <= TEXTURE_VRAM_SIZE)
+            repack_pending = true;
+
+        if (!evict_texture()) {
+            glDeleteTextures(1, &cur->name);
+            cur->name = 0;
+            if (cur->pal_index) {
+                vramBlock_deallocateBlock(glGlob->vramBlocks[1], cur->pal_index);
+                cur->pal_index = 0;
+            }
+            defer_texture();
+            return;
+        }
+    }
+
+    resident[resident_count++] = index;
+    resident_bytes += size;
+    upload_bytes += bytes;
+    texture_stats.misses++;
+
+    bind_texture(cur);
+}
+
+static bool read_texture_header(struct Texture *cur) {
+    // Check for a paletted texture header, and make sure its total size agrees with the format it describes
+    const uint32_t *header = (const uint32_t*)texture_address;
+    if (header[0] != TEXTURE_MAGIC)
+        return false;
+
+    const uint8_t *info = (const uint8_t*)&header[2];
+    const uint8_t type = info[0];
+    const uint8_t size_x = info[1] & 0xF;
+    const uint8_t size_y = info[1] >> 4;
+    const uint16_t pal_count = info[2] + 1;
+    if (type < GL_RGB4 || type > GL_RGB256 || size_x > 7 || size_y > 7)
+        return false;
+
+    const uint32_t texels = (1 << (size_x + size_y + 6)) * type_bits[type] / 8;
+    if (header[1] != TEXTURE_HEADER_WORDS * 4 + texels + ((pal_count + 1) & ~1) * 2)
+        return false;
+
+    cur->type = type;
+    cur->size_x = size_x;
+    cur->size_y = size_y;
+    cur->pal_count = pal_count;
+    cur->transparent = info[3] & 0x1;
+    return true;
 }
 
 static void load_texture() {
@@ -210,24 +463,21 @@ static void load_texture() {
     // Load the texture if it was found
     if (cur->address != NULL) {
         if (cur->name) {
-            glBindTexture(GL_TEXTURE_2D, cur->name);
+            bind_texture(cur);
+            texture_stats.hits++;
+#ifdef TARGET_HOST
+            residency_record(cur->address, texture_load_bytes(cur));
+#endif
             return;
         }
 
-        // Copy the texture back into VRAM if it was pushed out, pushing out other textures if necessary
-        glGenTextures(1, &cur->name);
-        glBindTexture(GL_TEXTURE_2D, cur->name);
-        while (!glTexImage2DAsync(GL_TEXTURE_2D, 0, cur->type, cur->size_x, cur->size_y, 0, TEXGEN_TEXCOORD, cur->address)) {
-            glDeleteTextures(1, &texture_map[texture_fifo[texture_fifo_end]].name);
-            texture_map[texture_fifo[texture_fifo_end]].name = 0;
-            texture_fifo_end = (texture_fifo_end + 1) & 0x7FF;
-        }
-        texture_fifo[texture_fifo_start] = index;
-        texture_fifo_start = (texture_fifo_start + 1) & 0x7FF;
+        // Copy the texture back into VRAM if it was pushed out
+        upload_texture(index);
         return;
     }
 
     cur->address = texture_address;
+    cur->data = texture_address;
 
     // Set the texture format; textures are converted to DS formats at compile time
     switch (texture_format) {
@@ -237,27 +487,260 @@ static void load_texture() {
         default:
             //printf("Unsupported texture format: %d\n", texture_format);
             glBindTexture(GL_TEXTURE_2D, cur->name = no_texture);
+            bound_texture = NULL;
+            tex_transparency = 0;
             return;
     }
 
-    // Determine the texture size in terms of 8 << x; textures are fitted to these constraints at compile time
-    const int width = texture_row_size << (4 - texture_bit_width);
-    const int height = ((texture_size << 1) >> texture_bit_width) / width;
-    for (cur->size_x = 0; (width  - 1) >> (cur->size_x + 3) != 0; cur->size_x++);
-    for (cur->size_y = 0; (height - 1) >> (cur->size_y + 3) != 0; cur->size_y++);
+    if (texture_format == G_IM_FMT_RGBA && read_texture_header(cur)) {
+        // Paletted textures store their format, size, and palette in a header instead
+        cur->data = texture_address + TEXTURE_HEADER_WORDS * 4;
+        cur->palette = (const uint16_t*)(cur->data + texture_bytes(cur));
+    } else {
+        // Determine the texture size in terms of 8 << x; textures are fitted to these constraints at compile time
+        const int width = texture_row_size << (4 - texture_bit_width);
+        const int height = ((texture_size << 1) >> texture_bit_width) / width;
+        for (cur->size_x = 0; (width  - 1) >> (cur->size_x + 3) != 0; cur->size_x++);
+        for (cur->size_y = 0; (height - 1) >> (cur->size_y + 3) != 0; cur->size_y++);
+    }
 
-    // Copy the texture into VRAM, pushing out other textures if necessary
-    glGenTextures(1, &cur->name);
-    glBindTexture(GL_TEXTURE_2D, cur->name);
-    while (!glTexImage2DAsync(GL_TEXTURE_2D, 0, cur->type, cur->size_x, cur->size_y, 0, TEXGEN_TEXCOORD, cur->address)) {
-        glDeleteTextures(1, &texture_map[texture_fifo[texture_fifo_end]].name);
-        texture_map[texture_fifo[texture_fifo_end]].name = 0;
-        texture_fifo_end = (texture_fifo_end + 1) & 0x7FF;
+    upload_texture(index);
+}
+
+ITCM_CODE static const Vtx_t *find_apex(const Vtx_t **tri, const Vtx_t *a, const Vtx_t *b) {
+    // Get the remaining vertex of a triangle if it contains the edge from a to b in its winding order
+    if (tri[0] == a && tri[1] == b) return tri[2];
+    if (tri[1] == a && tri[2] == b) return tri[0];
+    if (tri[2] == a && tri[0] == b) return tri[1];
+    return NULL;
+}
+
+ITCM_CODE static bool can_quad(const Vtx_t **s) {
+    // Two triangles in strip order can be drawn as a single quad if they form a parallelogram, and their colors and
+    // texture coordinates do too; otherwise the quad would be interpolated differently from the triangles
+    for (int i = 0; i < 3; i++) {
+        if (abs(s[0]->ob[i] + s[3]->ob[i] - s[1]->ob[i] - s[2]->ob[i]) > 1)
+            return false;
+        if (use_color && abs(s[0]->cn[i] + s[3]->cn[i] - s[1]->cn[i] - s[2]->cn[i]) > 8)
+            return false;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (use_texture && abs(s[0]->tc[i] + s[3]->tc[i] - s[1]->tc[i] - s[2]->tc[i]) > 1)
+            return false;
+    }
+    return true;
+}
+
+ITCM_CODE static int build_primitives(const Vtx_t **v, int count) {
+    // Greedily join consecutive triangles into strips, keeping them in their original order
+    int num_runs = 0;
+    int used = 0;
+
+    for (int t = 0; t < count;) {
+        const Vtx_t **s = &prim_vertices[used];
+        int n = 3;
+
+        // Rotate the first triangle so that the next one can continue the strip from its last edge, if possible
+        s[0] = v[t + 0];
+        s[1] = v[t + 1];
+        s[2] = v[t + 2];
+        for (int r = 0; r < 3 && t + 3 < count; r++) {
+            if (find_apex(&v[t + 3], v[t + (r + 2) % 3], v[t + (r + 1) % 3])) {
+                s[0] = v[t + r];
+                s[1] = v[t + (r + 1) % 3];
+                s[2] = v[t + (r + 2) % 3];
+                break;
+            }
+        }
+
+        // Extend the strip while the following triangles share the right edge; the winding alternates along a strip
+        for (t += 3; t < count; t += 3) {
+            const Vtx_t *apex = (n & 1) ? find_apex(&v[t], s[n - 1], s[n - 2]) : find_apex(&v[t], s[n - 2], s[n - 1]);
+            if (!apex) break;
+            s[n++] = apex;
+        }
+
+        // Lone triangles and quads can share a run with the ones before them, but each strip needs its own
+        int type = GL_TRIANGLE_STRIP;
+        if (n == 3) {
+            type = GL_TRIANGLE;
+        } else if (n == 4 && can_quad(s)) {
+            // Quads are sent in perimeter order
+            const Vtx_t *tmp = s[2];
+            s[2] = s[3];
+            s[3] = tmp;
+            type = GL_QUAD;
+        }
+
+        if (type != GL_TRIANGLE_STRIP && num_runs > 0 && prim_runs[num_runs - 1].type == type) {
+            prim_runs[num_runs - 1].count += n;
+        } else {
+            prim_runs[num_runs].type = type;
+            prim_runs[num_runs].start = used;
+            prim_runs[num_runs].count = n;
+            num_runs++;
+        }
+        used += n;
+    }
+
+    return num_runs;
+}
+
+ITCM_CODE static void draw_vertices_normal(const Vtx_t **v, int count, uint8_t tex_ofs) {
+    // Combine the vertex hashes with the state that affects the generated commands to get a key for the batch
+    uint32_t key = (texture_scale_s << 16) ^ texture_scale_t ^ (tex_ofs << 8) ^ (use_color << 1) ^ (use_texture << 2) ^ count;
+    for (int i = 0; i < count; i++) {
+        const uint32_t hash = vertex_hash[(const Vtx*)v[i] - vertex_buffer];
+        if (hash == 0) {
+            key = 0;
+            break;
+        }
+        key = (key ^ hash) * 0x01000193;
+    }
+
+    // Send the batch as a single DMA if it has already been lowered to a GX command list
+    const struct GxListSource source = {
+        .state = { (texture_scale_s << 16) | texture_scale_t, (tex_ofs << 8) | (use_color << 1) | use_texture },
+        .vertices = (const uint32_t *const *)v,
+        .count = count,
+    };
+    bool compile = false;
+    const uint32_t *verify = NULL;
+    if (key != 0) {
+        uint32_t sent;
+        const uint32_t *list = gx_list_lookup(key, &source, &compile, &sent);
+#ifdef GX_LIST_VERIFY
+        // Lower the batch again into scratch space, and compare it with the list, which is sent afterwards
+        if (list && gx_list_verify_begin(count)) {
+            verify = list;
+            compile = true;
+            list = NULL;
+        }
+#endif
+        if (list) {
+            glCallList(list);
+            vertex_stats.submitted += sent;
+            vertex_stats.saved += count - sent;
+            return;
+        }
+    } else {
+        gx_list_stats.skipped[GX_SKIP_DYNAMIC]++;
+    }
+
+    // Lower the batch to a GX command list if it's been seen before, and send it right away
+    if (compile && verify == NULL)
+        gx_list_begin(key, &source);
+
+    const int num_runs = build_primitives(v, count);
+    uint32_t sent = 0;
+    uint32_t last_color = 0;
+    uint32_t last_coord = 0;
+    bool first = true;
+
+    for (int r = 0; r < num_runs; r++) {
+        const struct PrimitiveRun *run = &prim_runs[r];
+        if (compile) gx_list_primitive(run->type);
+        else glBegin(run->type);
+
+        for (int i = run->start; i < run->start + run->count; i++) {
+            const Vtx_t *vtx = prim_vertices[i];
+
+            // Colors and texture coordinates stay set between vertices, so only send them when they change
+            if (use_color) {
+                const uint32_t color = (vtx->cn[0] << 16) | (vtx->cn[1] << 8) | vtx->cn[2];
+                if (first || color != last_color) {
+                    if (compile) gx_list_color(vtx->cn[0], vtx->cn[1], vtx->cn[2]);
+                    else glColor3b(vtx->cn[0], vtx->cn[1], vtx->cn[2]);
+                    last_color = color;
+                }
+            }
+            if (use_texture) {
+                const int16_t s = ((vtx->tc[0] * texture_scale_s) >> 17) + tex_ofs;
+                const int16_t t = ((vtx->tc[1] * texture_scale_t) >> 17) + tex_ofs;
+                const uint32_t coord = TEXTURE_PACK(s, t);
+                if (first || coord != last_coord) {
+                    if (compile) gx_list_texcoord(s, t);
+                    else glTexCoord2t16(s, t);
+                    last_coord = coord;
+                }
+            }
+            first = false;
+
+            if (compile) gx_list_vertex(vtx->ob[0], vtx->ob[1], vtx->ob[2]);
+            else glVertex3v16(vtx->ob[0], vtx->ob[1], vtx->ob[2]);
+        }
+        sent += run->count;
+    }
+
+    if (verify != NULL) {
+#ifdef GX_LIST_VERIFY
+        gx_list_verify_end(verify);
+#endif
+        glCallList(verify);
+    } else if (compile) {
+        glCallList(gx_list_end(sent));
+    }
+
+    vertex_stats.submitted += sent;
+    vertex_stats.saved += count - sent;
+}
+
+#ifdef PROJECTION_VERIFY
+struct ProjectionVerifyStats projection_verify;
+
+static void verify_projection(const Vtx_t **v, int count, const m4x4 *clip, bool check_z) {
+    // Compare vertices projected through the matrix that will be loaded against the position test results the old
+    // per-vertex path used; decals expect the position test Z with the offset applied, and 2D Z values aren't compared
+    for (int i = 0; i < count; i++) {
+        PosTest(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
+        const int32_t expected[4] = { PosTestXresult(), PosTestYresult(), PosTestZresult() - (3 << 4), PosTestWresult() };
+
+        bool match = true;
+        for (int j = 0; j < 4; j++) {
+            if (j == 2 && !check_z) continue;
+            const int64_t result = ((int64_t)v[i]->ob[0] * clip->m[j] + (int64_t)v[i]->ob[1] * clip->m[4 + j] +
+                                    (int64_t)v[i]->ob[2] * clip->m[8 + j] + ((int64_t)clip->m[12 + j] << 12)) >> 12;
+            if (result < expected[j] - 1 || result > expected[j] + 1)
+                match = false;
+        }
+
+        projection_verify.vertices++;
+        if (!match) projection_verify.mismatches++;
+    }
+}
+#endif
+
+ITCM_CODE static void cull_mult(m4x4 *dst, const m4x4 *src) {
+    // Multiply a software matrix the way the geometry engine does (dst = src * dst, with 12-bit fractionals)
+    const m4x4 old = *dst;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            int64_t sum = 0;
+            for (int k = 0; k < 4; k++)
+                sum += (int64_t)src->m[i * 4 + k] * old.m[k * 4 + j];
+            dst->m[i * 4 + j] = sum >> 12;
+        }
     }
-    texture_fifo[texture_fifo_start] = index;
-    texture_fifo_start = (texture_fifo_start + 1) & 0x7FF;
+    cull_clip_valid = false;
 }
 
+#ifdef PROJECTION_VERIFY
+static void verify_clip() {
+    // Compare the software clip matrix used for culling against the one the geometry engine combined
+    m4x4 clip;
+    glGetFixed(GL_GET_MATRIX_CLIP, clip.m);
+
+    bool match = true;
+    for (int i = 0; i < 16; i++) {
+        if (cull_clip.m[i] < clip.m[i] - 1 || cull_clip.m[i] > clip.m[i] + 1)
+            match = false;
+    }
+
+    projection_verify.matrices++;
+    if (!match) projection_verify.matrix_mismatches++;
+}
+#endif
+
 ITCM_CODE static void draw_vertices(const Vtx_t **v, int count) {
     // Get the alpha value and return early if it's 0 (alpha 0 is wireframe on the DS)
     // Since the DS only supports one alpha value per polygon, just use the one from first vertex
@@ -278,10 +761,11 @@ ITCM_CODE static void draw_vertices(const Vtx_t **v, int count) {
     // Clear the texture if it shouldn't be used, or load it if it's dirty
     if (!use_texture) {
         glBindTexture(GL_TEXTURE_2D, no_texture);
+        bound_texture = NULL;
         texture_dirty = true;
     } else if (texture_dirty) {
         load_texture();
-        glTexParameter(GL_TEXTURE_2D, tex_params);
+        glTexParameter(GL_TEXTURE_2D, tex_params | tex_transparency);
         texture_dirty = false;
     }
 
@@ -293,7 +777,6 @@ ITCM_CODE static void draw_vertices(const Vtx_t **v, int count) {
 
         // Apply the polygon attributes
         glPolyFmt(fmt);
-        glBegin(GL_TRIANGLE);
 
         // Incoming vertices expect W to be 1, not 1 << 12 like the DS sets
         // This is a hack to scale W values; it's reverted during matrix multiplication to prevent breakage
@@ -306,65 +789,37 @@ ITCM_CODE static void draw_vertices(const Vtx_t **v, int count) {
             }};
             glMatrixMode(GL_MODELVIEW);
             glMultMatrix4x4(&shrink);
+            cull_mult(&cull_modelview, &shrink);
             shrunk = true;
         }
 
         // Send the vertices to the 3D engine
         if ((other_mode_l & ZMODE_DEC) == ZMODE_DEC) {
-            for (int i = 0; i < count; i++) {
-                // Send the vertex attributes to the 3D engine
-                if (use_color) glColor3b(v[i]->cn[0], v[i]->cn[1], v[i]->cn[2]);
-                if (use_texture) glTexCoord2t16(((v[i]->tc[0] * texture_scale_s) >> 17) + tex_ofs, ((v[i]->tc[1] * texture_scale_t) >> 17) + tex_ofs);
-
-                // Use position test to project the vertex so the result can be hijacked before sending it for real
-                PosTest(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
-
-                // Push the current matrices to the stack, and load an identity matrix so the outgoing vertex won't be affected
-                glMatrixMode(GL_MODELVIEW);
-                glPushMatrix();
-                glLoadIdentity();
-                glMatrixMode(GL_PROJECTION);
-                glPushMatrix();
-
-                // Reduce the Z value for decal mode to reduce Z-fighting
-                // Since the W value can't be set directly, use a scaling matrix with a vertex of 1s to send the coordinates
-                const m4x4 vertex = {{
-                    PosTestXresult(), 0, 0, 0,
-                    0, PosTestYresult(), 0, 0,
-                    0, 0, PosTestZresult() - (3 << 4), 0,
-                    0, 0, 0, PosTestWresult()
-                }};
-                glLoadMatrix4x4(&vertex);
-                glVertex3v16(1 << 12, 1 << 12, 1 << 12);
+            // Reduce the Z value for decal mode to reduce Z-fighting, by offsetting it in clip space
+            // The combined matrix is read back once and loaded with the offset applied, so the vertices can be sent normally
+            m4x4 clip;
+            glGetFixed(GL_GET_MATRIX_CLIP, clip.m);
+            clip.m[14] -= 3 << 4;
+#ifdef PROJECTION_VERIFY
+            verify_projection(v, count, &clip, true);
+#endif
+            glMatrixMode(GL_MODELVIEW);
+            glPushMatrix();
+            glLoadIdentity();
+            glMatrixMode(GL_PROJECTION);
+            glPushMatrix();
+            glLoadMatrix4x4(&clip);
 
-                // Restore the original matrices
-                glPopMatrix(1);
-                glMatrixMode(GL_MODELVIEW);
-                glPopMatrix(1);
-            }
-        } else {
-            // Send the vertices normally
-            if (__builtin_expect((use_color), true)) {
-                if (use_texture) {
-                    for (int i = 0; i < count; i++) {
-                        glColor3b(v[i]->cn[0], v[i]->cn[1], v[i]->cn[2]);
-                        glTexCoord2t16(((v[i]->tc[0] * texture_scale_s) >> 17) + tex_ofs, ((v[i]->tc[1] * texture_scale_t) >> 17) + tex_ofs);
-                        glVertex3v16(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
-                    }
-                } else {
-                    for (int i = 0; i < count; i++) {
-                        glColor3b(v[i]->cn[0], v[i]->cn[1], v[i]->cn[2]);
-                        glVertex3v16(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
-                    }
-                }
-            } else {
-                if (use_texture) {
-                    for (int i = 0; i < count; i++) {
-                        glTexCoord2t16(((v[i]->tc[0] * texture_scale_s) >> 17) + tex_ofs, ((v[i]->tc[1] * texture_scale_t) >> 17) + tex_ofs);
-                        glVertex3v16(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
-                    }
-                }
-            }
+            draw_vertices_normal(v, count, tex_ofs);
+
+            // Restore the original matrices
+            glPopMatrix(1);
+            glMatrixMode(GL_MODELVIEW);
+            glPopMatrix(1);
+        } else if (use_color || use_texture) {
+            // Send the vertices normally as strips and quads, using a compiled command list if the batch has been lowered already
+            // Nothing is sent without vertex colors or texture coordinates
+            draw_vertices_normal(v, count, tex_ofs);
         }
 
         // As part of the depth hack, move the hijacked Z value to the front once normal polygons start being sent
@@ -390,40 +845,91 @@ ITCM_CODE static void draw_vertices(const Vtx_t **v, int count) {
         glPushMatrix();
         glMultMatrix4x4(&enlarge);
 
+        // Depth test can't be disabled on the DS; this is a problem, since 2D elements are usually drawn this way
+        // This hack sets decreasing Z values so that these polygons will be properly rendered on top of each other
+        // The combined matrix is read back once, and its Z column replaced so that Z comes only from the translation,
+        // which is updated whenever the depth changes (every 2 triangles)
+        m4x4 clip;
+        glGetFixed(GL_GET_MATRIX_CLIP, clip.m);
+        clip.m[2] = clip.m[6] = clip.m[10] = 0;
+#ifdef PROJECTION_VERIFY
+        verify_projection(v, count, &clip, false);
+#endif
+        glLoadIdentity();
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+
+        gx_list_stats.skipped[GX_SKIP_2D]++;
+        vertex_stats.submitted += count;
         for (int i = 0; i < count; i++) {
-            // Send the vertex attributes to the 3D engine
+            const int32_t depth = ((--z_depth) / 6) << 4;
+            if (i == 0 || clip.m[14] != depth) {
+                clip.m[14] = depth;
+                glLoadMatrix4x4(&clip);
+            }
+
+            // Send the vertex to the 3D engine
             if (use_color) glColor3b(v[i]->cn[0], v[i]->cn[1], v[i]->cn[2]);
             if (use_texture) glTexCoord2t16(((v[i]->tc[0] * texture_scale_s) >> 17) + tex_ofs, ((v[i]->tc[1] * texture_scale_t) >> 17) + tex_ofs);
+            glVertex3v16(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
+        }
 
-            // Use position test to project the vertex so the result can be hijacked before sending it for real
-            PosTest(v[i]->ob[0], v[i]->ob[1], v[i]->ob[2]);
-
-            // Push the current matrices to the stack, and load an identity matrix so the outgoing vertex won't be affected
-            glPushMatrix();
-            glLoadIdentity();
-            glMatrixMode(GL_PROJECTION);
-            glPushMatrix();
-
-            // Depth test can't be disabled on the DS; this is a problem, since 2D elements are usually drawn this way
-            // This hack sets decreasing Z values so that these polygons will be properly rendered on top of each other
-            // Since the W value can't be set directly, use a scaling matrix with a vertex of 1s to send the coordinates
-            const m4x4 vertex = {{
-                PosTestXresult(), 0, 0, 0,
-                0, PosTestYresult(), 0, 0,
-                0, 0, ((--z_depth) / 6) << 4, 0,
-                0, 0, 0, PosTestWresult()
-            }};
-            glLoadMatrix4x4(&vertex);
-            glVertex3v16(1 << 12, 1 << 12, 1 << 12);
+        // Restore the original matrices
+        glPopMatrix(1);
+        glMatrixMode(GL_MODELVIEW);
+        glPopMatrix(1);
+    }
+}
 
-            // Restore the original matrices
-            glPopMatrix(1);
-            glMatrixMode(GL_MODELVIEW);
-            glPopMatrix(1);
+ITCM_CODE static uint8_t chunk_outcode(const Vtx *vertices, int count) {
+    // Find the bounding box of the chunk in model space
+    int32_t lo[3] = { INT16_MAX, INT16_MAX, INT16_MAX };
+    int32_t hi[3] = { INT16_MIN, INT16_MIN, INT16_MIN };
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (vertices[i].v.ob[j] < lo[j]) lo[j] = vertices[i].v.ob[j];
+            if (vertices[i].v.ob[j] > hi[j]) hi[j] = vertices[i].v.ob[j];
         }
+    }
 
-        glPopMatrix(1);
+    if (!cull_clip_valid) {
+        // The clip matrix is the modelview times the projection, like the geometry engine combines them
+        cull_clip = cull_projection;
+        cull_mult(&cull_clip, &cull_modelview);
+        cull_clip_valid = true;
+#ifdef PROJECTION_VERIFY
+        verify_clip();
+#endif
     }
+
+    // Vertices are drawn with the modelview shrunk (see draw_vertices), so weigh the translation the same way if it
+    // hasn't been shrunk yet
+    const int shift = shrunk ? 12 : 0;
+
+    // Keep only the planes that all 8 corners are outside of
+    uint8_t outcode = 0x3F;
+    for (int c = 0; c < 8 && outcode; c++) {
+        const int32_t x = (c & 1) ? hi[0] : lo[0];
+        const int32_t y = (c & 2) ? hi[1] : lo[1];
+        const int32_t z = (c & 4) ? hi[2] : lo[2];
+
+        int64_t p[4];
+        for (int j = 0; j < 4; j++)
+            p[j] = (int64_t)x * cull_clip.m[j] + (int64_t)y * cull_clip.m[4 + j] + (int64_t)z * cull_clip.m[8 + j] +
+                   ((int64_t)cull_clip.m[12 + j] << shift);
+
+        uint8_t code = 0;
+        if (p[0] < -p[3]) code |= (1 << 0);
+        if (p[0] >  p[3]) code |= (1 << 1);
+        if (p[1] < -p[3]) code |= (1 << 2);
+        if (p[1] >  p[3]) code |= (1 << 3);
+        if (p[2] < -p[3]) code |= (1 << 4);
+        if (p[2] >  p[3]) code |= (1 << 5);
+        outcode &= code;
+    }
+
+    if (outcode) vertex_stats.chunks_culled++;
+    return outcode;
 }
 
 ITCM_CODE static void g_vtx(Gwords *words) {
@@ -434,6 +940,10 @@ ITCM_CODE static void g_vtx(Gwords *words) {
     // Store vertices in the vertex buffer
     memcpy(&vertex_buffer[index - count], vertices, count * sizeof(Vtx));
 
+    // Test the chunk against the view frustum; 2D elements are drawn with their own matrix setup, so they're left alone
+    const uint8_t outcode = (geometry_mode & G_ZBUFFER) ? chunk_outcode(vertices, count) : 0;
+    memset(&vertex_outcode[index - count], outcode, count);
+
     if (geometry_mode & G_LIGHTING) {
         // Recalculate transformed light vectors if the lights or modelview matrix changed
         if (lights_dirty) {
@@ -492,23 +1002,48 @@ ITCM_CODE static void g_vtx(Gwords *words) {
             v->cn[2] = (b > 0xFF) ? 0xFF : b;
         }
     }
+
+    // Hash the final vertex contents so batches that use them can be matched with compiled command lists
+    // Vertices generated for the current frame won't be seen again, so they're marked as not worth compiling
+    if ((uint32_t)((const uint8_t*)vertices - dynamic_start) < sizeof(Gfx) * GFX_POOL_SIZE) {
+        for (int i = index - count; i < index; i++)
+            vertex_hash[i] = 0;
+    } else {
+        for (int i = index - count; i < index; i++) {
+            const uint32_t *w = (const uint32_t*)&vertex_buffer[i];
+            uint32_t h = w[0] * 0x9E3779B1;
+            h = (h ^ w[1]) * 0x9E3779B1;
+            h = (h ^ w[2]) * 0x9E3779B1;
+            vertex_hash[i] = (h ^ w[3]) | 1;
+        }
+    }
+}
+
+ITCM_CODE static void batch_triangle(uint32_t word) {
+    const uint8_t a = ((word >> 16) & 0xFF) >> 1;
+    const uint8_t b = ((word >>  8) & 0xFF) >> 1;
+    const uint8_t c = ((word >>  0) & 0xFF) >> 1;
+
+    // Drop the triangle if all of its vertices are outside the same frustum plane
+    if ((vertex_outcode[a] & vertex_outcode[b] & vertex_outcode[c]) && (geometry_mode & G_ZBUFFER)) {
+        vertex_stats.tris_culled++;
+        return;
+    }
+
+    vertex_batch[batch_count++] = &vertex_buffer[a].v;
+    vertex_batch[batch_count++] = &vertex_buffer[b].v;
+    vertex_batch[batch_count++] = &vertex_buffer[c].v;
 }
 
 ITCM_CODE static void g_tri1(Gwords *words) {
     // Batch a triangle to render
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >> 16) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >>  8) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >>  0) & 0xFF) >> 1].v;
+    batch_triangle(words->w0);
 }
 
 ITCM_CODE static void g_tri2(Gwords *words) {
     // Batch two triangles to render
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >> 16) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >>  8) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w0 >>  0) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w1 >> 16) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w1 >>  8) & 0xFF) >> 1].v;
-    vertex_batch[batch_count++] = &vertex_buffer[((words->w1 >>  0) & 0xFF) >> 1].v;
+    batch_triangle(words->w0);
+    batch_triangle(words->w1);
 }
 
 static void g_texture(Gwords *words) {
@@ -521,6 +1056,14 @@ static void g_popmtx(Gwords *words) {
     // Pop matrices from the modelview stack
     glMatrixMode(GL_MODELVIEW);
     glPopMatrix(words->w1 / 64);
+
+    // Pop the software copy to match
+    const uint32_t count = words->w1 / 64;
+    if (count > 0) {
+        cull_depth = (count < cull_depth) ? (cull_depth - count) : 0;
+        cull_modelview = cull_stack[cull_depth];
+        cull_clip_valid = false;
+    }
 }
 
 static void g_geometrymode(Gwords *words) {
@@ -538,22 +1081,19 @@ static void g_geometrymode(Gwords *words) {
 }
 
 ITCM_CODE static void g_mtx(Gwords *words) {
-    // Load a matrix with 16-bit fractionals
-    m4x4 matrix;
-    for (int i = 0; i < 16; i += 2) {
-        const uint32_t *data = &((uint32_t*)words->w1)[i / 2];
-        matrix.m[i + 0] = (int32_t)((data[0] & 0xFFFF0000) | (data[8] >> 16));
-        matrix.m[i + 1] = (int32_t)((data[0] << 16) | (data[8] & 0x0000FFFF));
-    }
+    // Matrices are stored in the DS layout with 16-bit fractionals (see GBI_NATIVE_MTX), so they can be used as-is
+    const m4x4 *data = (const m4x4*)words->w1;
 
     // Perform a matrix operation
     const uint8_t params = words->w0 ^ G_MTX_PUSH;
+    cull_clip_valid = false;
     if (params & G_MTX_PROJECTION) {
         glMatrixMode(GL_PROJECTION);
 
         // Load or multiply the projection matrix
         if (params & G_MTX_LOAD) {
-            glLoadMatrix4x4(&matrix);
+            glLoadMatrix4x4(data);
+            cull_projection = *data;
         } else {
             // To preserve some precision, the projection matrix isn't shifted to have 12-bit fractionals
             // Multiplication still needs to work though, so scale the matrix before multiplying it
@@ -564,8 +1104,10 @@ ITCM_CODE static void g_mtx(Gwords *words) {
                 0, 0, 0, 1 << 8
             }};
             glMultMatrix4x4(&shrink);
+            cull_mult(&cull_projection, &shrink);
 
-            glMultMatrix4x4(&matrix);
+            glMultMatrix4x4(data);
+            cull_mult(&cull_projection, data);
         }
     } else {
         glMatrixMode(GL_MODELVIEW);
@@ -573,16 +1115,20 @@ ITCM_CODE static void g_mtx(Gwords *words) {
         // Push the current modelview matrix to the stack if requested
         if (params & G_MTX_PUSH) {
             glPushMatrix();
+            if (cull_depth < 31)
+                cull_stack[cull_depth++] = cull_modelview;
         }
 
         // Shift the matrix elements so they have 12-bit fractionals for the DS
+        m4x4 matrix;
         for (int i = 0; i < 16; i++) {
-            matrix.m[i] >>= 4;
+            matrix.m[i] = data->m[i] >> 4;
         }
 
         // Load or multiply the modelview matrix
         if (params & G_MTX_LOAD) {
             glLoadMatrix4x4(&matrix);
+            cull_modelview = matrix;
         } else {
             // Revert the W value scaling hack so matrix multiplication works properly
             if (shrunk) {
@@ -593,9 +1139,11 @@ ITCM_CODE static void g_mtx(Gwords *words) {
                     0, 0, 0, 1 << 24
                 }};
                 glMultMatrix4x4(&enlarge);
+                cull_mult(&cull_modelview, &enlarge);
             }
 
             glMultMatrix4x4(&matrix);
+            cull_mult(&cull_modelview, &matrix);
         }
 
         shrunk = false;
@@ -728,7 +1276,7 @@ ITCM_CODE static void g_rdphalf_2(Gwords *words) {
     // Load the texture if it's dirty
     if (texture_dirty) {
         load_texture();
-        glTexParameter(GL_TEXTURE_2D, tex_params);
+        glTexParameter(GL_TEXTURE_2D, tex_params | tex_transparency);
         texture_dirty = false;
     }
 
@@ -844,6 +1392,7 @@ static void g_fillrect(Gwords *words) {
 
     // Clear the texture
     glBindTexture(GL_TEXTURE_2D, no_texture);
+    bound_texture = NULL;
     texture_dirty = true;
 
     // Apply the polygon attributes and the fill color
@@ -1020,6 +1569,7 @@ ITCM_CODE static void execute(Gfx* cmd) {
 
             default:
                 //printf("Unsupported GBI command: 0x%.2X\n", opcode);
+                gx_list_stats.unsupported[opcode]++;
                 break;
         }
 
@@ -1031,9 +1581,10 @@ static void end_frame() {
     // Count a frame (triggered at V-blank)
     frame_count++;
 
-    // Update VRAM and OAM for the next frame
-    if (glTexCount > 0) glTexSync();
+    // Update VRAM, OAM, and the skybox layer for the next frame
+    if (glTexCount > 0 || glPalCount > 0) glTexSync();
     oamUpdate(&oamSub);
+    skybox_commit();
 }
 
 static uint16_t *bitmap_init(const uint32_t *bitmap, uint32_t length) {
@@ -1059,7 +1610,7 @@ static uint16_t *bitmap_init_press(const uint32_t *bitmap, uint32_t length) {
 
 void renderer_init() {
     // Set up the screens
-    videoSetMode(MODE_0_3D);
+    videoSetMode(MODE_5_3D);
     videoSetModeSub(MODE_0_2D);
 
 #ifdef ENABLE_FPS
@@ -1088,6 +1639,7 @@ void renderer_init() {
 #endif
     vramSetBankD(VRAM_D_SUB_SPRITE);
     vramSetBankE(VRAM_E_TEX_PALETTE);
+    skybox_init();
 
     // Generate an empty texture for when no texture should be used
     glGenTextures(1, &no_texture);
@@ -1169,9 +1721,38 @@ void draw_frame(Gfx *display_list) {
     z_depth = 0x1000 * 6;
     fog_status = 0;
 
+    // Start the matrices over, so the software copies used for culling can't drift from the geometry engine's
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    for (int i = 0; i < 16; i++)
+        cull_projection.m[i] = cull_modelview.m[i] = (i % 5 == 0) ? (1 << 12) : 0;
+    cull_depth = 0;
+    cull_clip_valid = false;
+    shrunk = false;
+
+    // Vertices inside the frame's display list pool are regenerated every frame
+    dynamic_start = (const uint8_t*)display_list;
+
+    // Start a new frame for texture residency, and clear out fragmented texture VRAM if needed
+    texture_frame++;
+    if (repack_pending)
+        repack_textures();
+
+#ifdef TRACE_CAPTURE
+    // Save the frame's display lists and everything they reference, if it's time for another capture
+    trace_frame(display_list);
+#endif
+
     // Process and draw the frame
+    profiler_switch_phase(PHASE_RENDER);
+    profiler_log_gfx_time(TASKS_QUEUED);
     execute(display_list);
+    budget_update();
     glFlush(GL_TRANS_MANUALSORT);
+    skybox_update();
+    profiler_log_gfx_time(RSP_COMPLETE);
 
     // Configure fog based on the frame parameters
     if (fog_status) {
@@ -1206,8 +1787,11 @@ void draw_frame(Gfx *display_list) {
             ? sprites[i].gfx_press : sprites[i].gfx_release, -1, false, false, sprites[i].vflip, false, false);
 
     // Limit to 30FPS by waiting for up to 2 frames, depending on how long it took the current frame to render
+    profiler_switch_phase(PHASE_WAIT);
     for (int i = frame_count; i < 2; i++)
         swiWaitForVBlank();
+    profiler_log_gfx_time(RDP_COMPLETE);
+    profiler_switch_phase(PHASE_GAME);
 
     // Reset the frame counter
     frame_count = 0;
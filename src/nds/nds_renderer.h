@@ -1,6 +1,17 @@
 #ifndef NDS_RENDERER_H
 #define NDS_RENDERER_H
 
+// Texture and palette data copied into VRAM is limited per V-blank, with the rest deferred to later frames
+// DMA into VRAM manages a bit over 100KB in the V-blank period, so this leaves room for everything else done there
+#define UPLOAD_BUDGET 0x10000
+
+// Texture VRAM available in banks A, B, and C; bank C is used by the console when FPS is enabled
+#ifdef ENABLE_FPS
+#define TEXTURE_VRAM_SIZE 0x40000
+#else
+#define TEXTURE_VRAM_SIZE 0x60000
+#endif
+
 enum Sprites {
     C_LEFT,
     C_RIGHT,
@@ -20,9 +31,43 @@ struct Sprite {
     bool pressed;
 };
 
+struct TextureStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t deferred;
+    uint32_t repacks;
+    uint32_t bytes_uploaded;
+};
+
+struct VertexStats {
+    uint32_t submitted;
+    uint32_t saved;
+    uint32_t chunks_culled;
+    uint32_t tris_culled;
+};
+
+#ifdef PROJECTION_VERIFY
+struct ProjectionVerifyStats {
+    uint32_t vertices;
+    uint32_t mismatches;
+    uint32_t matrices;          // Clip matrices rebuilt in software for culling
+    uint32_t matrix_mismatches;
+};
+
+extern struct ProjectionVerifyStats projection_verify;
+#endif
+
 extern struct Sprite sprites[MAX_SPRITES];
+extern struct TextureStats texture_stats;
+extern struct VertexStats vertex_stats;
 
 extern void renderer_init();
 extern void draw_frame(Gfx *display_list);
 
+#ifdef TARGET_HOST
+// Every texture lookup is passed to the residency simulator in src/host, with the bytes a load would copy
+extern void residency_record(const void *address, uint32_t bytes);
+#endif
+
 #endif // NDS_RENDERER_H
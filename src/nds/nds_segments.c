@@ -0,0 +1,112 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nds_include.h"
+#include <filesystem.h>
+
+#include "nds_segments.h"
+#include "game/memory.h"
+
+// Segments that aren't linked into the binary are streamed from NitroFS when the level script loads them
+// Each file is named after its segment's ROM symbol, so "_water_skybox_mio0SegmentRomStart" is loaded from
+// "water_skybox.lz", and is compressed in the BIOS LZ77 format
+#ifdef TARGET_HOST
+#define SEGMENT_ROOT NITROFS_ROOT
+#else
+#define SEGMENT_ROOT "nitro:/"
+#endif
+
+// Only skyboxes are streamed; the level and actor segments are linked with absolute pointers into each other and
+// the code, so they'd need relocating first, and stay in the binary
+#define SYMBOL_SUFFIX "SegmentRomStart"
+#define MIO0_SUFFIX "_mio0"
+#define LZ77_TYPE 0x10
+#define MAX_SEGMENT_FILES 32
+#define MAX_SEGMENT_NAME 32
+
+// The files are listed once, so loading a segment that isn't streamed doesn't have to probe NitroFS
+static char segment_files[MAX_SEGMENT_FILES][MAX_SEGMENT_NAME];
+static int segment_file_count;
+static uint32_t generation;
+
+void segments_init() {
+    // Without NitroFS, streamed segments are reported missing, and whatever uses them goes without
+    if (!nitroFSInit(NULL))
+        return;
+
+    DIR *dir = opendir(SEGMENT_ROOT);
+    if (dir == NULL)
+        return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && segment_file_count < MAX_SEGMENT_FILES) {
+        const size_t length = strlen(entry->d_name);
+        if (length > 3 && length < MAX_SEGMENT_NAME && !strcmp(&entry->d_name[length - 3], ".lz"))
+            strcpy(segment_files[segment_file_count++], entry->d_name);
+    }
+    closedir(dir);
+}
+
+uint32_t segments_generation() {
+    // Changes whenever a segment is streamed in, since the pool will likely put the next one at the same address
+    return generation;
+}
+
+static bool segment_streamed(const char *path) {
+    const char *name = &path[strlen(SEGMENT_ROOT)];
+    for (int i = 0; i < segment_file_count; i++) {
+        if (!strcmp(segment_files[i], name))
+            return true;
+    }
+    return false;
+}
+
+static bool segment_path(const char *symbol, char *path, size_t size) {
+    // Strip the underscore and suffixes from the symbol name to get the file name
+    size_t length = strlen(symbol);
+    if (symbol[0] != '_' || length < strlen(SYMBOL_SUFFIX) + 1)
+        return false;
+    length -= strlen(SYMBOL_SUFFIX) + 1;
+    if (length > strlen(MIO0_SUFFIX) && !strncmp(&symbol[1 + length - strlen(MIO0_SUFFIX)], MIO0_SUFFIX, strlen(MIO0_SUFFIX)))
+        length -= strlen(MIO0_SUFFIX);
+    return snprintf(path, size, SEGMENT_ROOT "%.*s.lz", (int)length, &symbol[1]) < (int)size;
+}
+
+void *load_segment_file(s32 segment, const char *symbol) {
+    char path[64];
+    void *dest = NULL;
+
+    // Segments that are linked in have no file; their base is cleared so nothing uses a stale one
+    FILE *file = (symbol != NULL && segment_path(symbol, path, sizeof(path)) && segment_streamed(path)) ?
+                 fopen(path, "rb") : NULL;
+    if (file == NULL) {
+        set_segment_base_addr(segment, NULL);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const u32 compSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // Read the file into the right side of the pool, and decompress it into the left like a MIO0 segment
+    u32 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+    if (compressed != NULL) {
+        // Check the header before handing it to the BIOS, which trusts it completely
+        if (compSize >= 4 && fread(compressed, 1, compSize, file) == compSize &&
+            (compressed[0] & 0xFF) == LZ77_TYPE && (compressed[0] >> 8) != 0) {
+            dest = main_pool_alloc(compressed[0] >> 8, MEMORY_POOL_LEFT);
+            if (dest != NULL) {
+                // The data is written through the data cache, so flush it before anything DMAs from it
+                swiDecompressLZSSWram(compressed, dest);
+                DC_FlushRange(dest, compressed[0] >> 8);
+                generation++;
+            }
+        }
+        main_pool_free(compressed);
+    }
+
+    fclose(file);
+    set_segment_base_addr(segment, dest);
+    return dest;
+}
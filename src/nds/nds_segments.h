@@ -0,0 +1,9 @@
+#ifndef NDS_SEGMENTS_H
+#define NDS_SEGMENTS_H
+
+#include <stdint.h>
+
+extern void segments_init();
+extern uint32_t segments_generation();
+
+#endif // NDS_SEGMENTS_H
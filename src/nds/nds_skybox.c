@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "nds_include.h"
+
+#include "nds_skybox.h"
+#include "nds_segments.h"
+#include "game/skybox.h"
+
+// Skyboxes are drawn on main background 3, an extended rotation layer behind the 3D one, using banks F and G
+// skyconv converts each one to 8-bit tiles; the image is 256x256 texels, so horizontal wrapping covers the full 360 degrees
+// Layout: "NBG0", tile count (u16), padding (u16), palette (256 x u16), map (32 x 32 x u16), tiles (count x 64 bytes)
+#define SKYBOX_MAGIC 0x3047424E // "NBG0"
+#define SKYBOX_MAP_BASE 15      // The map goes in the last 2KB, after room for 480 tiles
+#define SKYBOX_MAX_TILES 480
+
+struct SkyboxHeader {
+    uint32_t magic;
+    uint16_t tile_count;
+    uint16_t padding;
+    uint16_t palette[256];
+    uint16_t map[32 * 32];
+};
+
+static struct SkyboxLayer pending;
+static uint32_t pending_generation;
+static bool pending_ready;
+
+// Streamed skyboxes tend to land at the same address, so the segment generation tells them apart
+static const struct SkyboxHeader *loaded;
+static uint32_t loaded_generation;
+static uint8_t loaded_color[3];
+static bool shown;
+
+void skybox_init() {
+    // Give banks F and G to the main background, and keep the texture palette allocator from using them
+    vramSetBankF(VRAM_F_MAIN_BG_0x06000000);
+    vramSetBankG(VRAM_G_MAIN_BG_0x06004000);
+    glLockVRAMBank(VRAM_F);
+    glLockVRAMBank(VRAM_G);
+
+    REG_BG3CNT = BG_RS_32x32 | BG_MAP_BASE(SKYBOX_MAP_BASE) | BG_TILE_BASE(0) | BG_PRIORITY(3) | BG_WRAP_ON;
+    REG_BG3PB = 0;
+    REG_BG3PC = 0;
+    BG_PALETTE[0] = 0; // Shown as the backdrop when there's no skybox
+}
+
+void skybox_update() {
+    // Hand the skybox for the frame that was just flushed to the next V-blank, when it will be shown
+    // The layer is cleared for the next frame, so it's hidden if nothing sets it again
+    const int ime = enterCriticalSection();
+    pending = gSkyboxLayer;
+    pending_generation = segments_generation();
+    pending_ready = true;
+    leaveCriticalSection(ime);
+    gSkyboxLayer.image = NULL;
+}
+
+static void load_palette() {
+    // Apply the skybox color to the palette, like the vertex colors did for the tiles
+    for (int i = 1; i < 256; i++) {
+        const uint16_t color = loaded->palette[i];
+        const int r = ((color >>  0) & 0x1F) * loaded_color[0] / 0xFF;
+        const int g = ((color >>  5) & 0x1F) * loaded_color[1] / 0xFF;
+        const int b = ((color >> 10) & 0x1F) * loaded_color[2] / 0xFF;
+        BG_PALETTE[i] = RGB15(r, g, b);
+    }
+}
+
+void skybox_commit() {
+    // Show or hide the layer during V-blank, so it changes at the same time as the 3D image
+    if (!pending_ready)
+        return;
+    pending_ready = false;
+
+    const struct SkyboxHeader *header = (const struct SkyboxHeader*)pending.image;
+    if (header == NULL || header->magic != SKYBOX_MAGIC || header->tile_count > SKYBOX_MAX_TILES) {
+        if (shown) {
+            // Make the 3D layer's clear color opaque again, so the frame looks like it did before
+            videoBgDisable(3);
+            REG_BLDCNT = 0;
+            glClearColor(0, 0, 0, 31);
+            shown = false;
+        }
+        loaded = NULL;
+        return;
+    }
+
+    if (header != loaded || pending_generation != loaded_generation) {
+        // Copy a new skybox into VRAM; this only happens when entering an area
+        dmaCopy(header + 1, BG_TILE_RAM(0), header->tile_count * 64);
+        dmaCopy(header->map, BG_MAP_RAM(SKYBOX_MAP_BASE), sizeof(header->map));
+        loaded = header;
+        loaded_generation = pending_generation;
+        memcpy(loaded_color, pending.color, sizeof(loaded_color));
+        load_palette();
+    } else if (memcmp(loaded_color, pending.color, sizeof(loaded_color))) {
+        memcpy(loaded_color, pending.color, sizeof(loaded_color));
+        load_palette();
+    }
+
+    // Scale the layer so the 256x192 screen covers the same part of the skybox as the N64 one did
+    REG_BG3PA = pending.width / 256;
+    REG_BG3PD = pending.height / 192;
+    REG_BG3X = pending.x;
+    REG_BG3Y = pending.y;
+
+    if (!shown) {
+        // Let the layer show through where nothing is drawn, and blend translucent 3D pixels with it
+        glClearColor(0, 0, 0, 0);
+        REG_BLDCNT = BLEND_ALPHA | BLEND_SRC_BG0 | BLEND_DST_BG3;
+        videoBgEnable(3);
+        shown = true;
+    }
+}
@@ -0,0 +1,8 @@
+#ifndef NDS_SKYBOX_H
+#define NDS_SKYBOX_H
+
+extern void skybox_init();
+extern void skybox_update();
+extern void skybox_commit();
+
+#endif // NDS_SKYBOX_H
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <string.h>
+#include <PR/gbi.h>
+
+#include "nds_include.h"
+
+#include "nds_trace.h"
+#include "game/area.h"
+
+#ifdef TRACE_CAPTURE
+
+// A frame is captured once things have settled after entering an area, and then every so often while staying in it
+#define SETTLE_FRAMES 60
+#define CAPTURE_INTERVAL 300
+
+#define BLOCK_TABLE_SIZE 8192 // Must be a power of 2
+#define BLOCK_TABLE_LIMIT (BLOCK_TABLE_SIZE * 3 / 4)
+
+static struct TraceBlock blocks[BLOCK_TABLE_SIZE];
+static uint16_t block_index[BLOCK_TABLE_SIZE];
+static uint32_t block_count;
+static bool overflowed;
+
+static int16_t last_level = -1;
+static int16_t last_area = -1;
+static uint32_t frames_in_area;
+
+static struct TraceBlock *find_block(uint32_t address, uint32_t type) {
+    // Look up a block by address and type, using the address as the hash
+    uint32_t index = (address >> 3) & (BLOCK_TABLE_SIZE - 1);
+    while (blocks[index].size != 0 || blocks[index].address != 0) {
+        if (blocks[index].address == address && blocks[index].type == type)
+            return &blocks[index];
+        index = (index + 1) & (BLOCK_TABLE_SIZE - 1);
+    }
+    return &blocks[index];
+}
+
+static struct TraceBlock *add_block(uint32_t address, uint32_t size, uint32_t type) {
+    // Record a block, growing it if it was already recorded with a smaller size
+    struct TraceBlock *block = find_block(address, type);
+    if (block->address == address && block->type == type) {
+        if (size > block->size)
+            block->size = size;
+        return block;
+    }
+
+    if (block_count == BLOCK_TABLE_LIMIT) {
+        overflowed = true;
+        return NULL;
+    }
+
+    block->address = address;
+    block->size = size;
+    block->type = type;
+    block_index[block_count++] = block - blocks;
+    return block;
+}
+
+static void walk_list(const Gfx *cmd) {
+    // Follow a display list the same way the renderer executes it, recording everything it references
+    const Gfx *start = cmd;
+    add_block((uint32_t)cmd, 0, TRACE_DL);
+
+    while (true) {
+        const uint32_t w0 = cmd->words.w0;
+        const uint32_t w1 = cmd->words.w1;
+
+        switch (w0 >> 24) {
+            case G_VTX:     add_block(w1, ((w0 >> 12) & 0xFF) * sizeof(Vtx), TRACE_VTX);  break;
+            case G_MTX:     add_block(w1, sizeof(Mtx), TRACE_MTX);                         break;
+            case G_MOVEMEM: add_block(w1, (((w0 >> 19) & 0x1F) + 1) * 8, TRACE_MEM);       break;
+            case G_SETTIMG: add_block(w1, 8, TRACE_TEX);                                   break;
+
+            case G_DL: {
+                // Lists that were already walked don't need to be walked again
+                const struct TraceBlock *target = find_block(w1, TRACE_DL);
+                const bool seen = (target->address == w1 && target->type == TRACE_DL);
+
+                if (w0 & (1 << 16)) { // Without return
+                    add_block((uint32_t)start, (cmd + 1 - start) * sizeof(Gfx), TRACE_DL);
+                    if (!seen) walk_list((const Gfx*)w1);
+                    return;
+                } else if (!seen) { // With return
+                    walk_list((const Gfx*)w1);
+                }
+                break;
+            }
+
+            case G_ENDDL:
+                add_block((uint32_t)start, (cmd + 1 - start) * sizeof(Gfx), TRACE_DL);
+                return;
+        }
+
+        cmd++;
+    }
+}
+
+static void capture(Gfx *display_list) {
+    memset(blocks, 0, sizeof(blocks));
+    block_count = 0;
+    overflowed = false;
+
+    walk_list(display_list);
+    if (overflowed)
+        return;
+
+    // Lay out the block table in the order the blocks were found, followed by their data
+    struct TraceFrame frame;
+    frame.magic = TRACE_MAGIC;
+    frame.level = gCurrLevelNum;
+    frame.area = gCurrAreaIndex;
+    frame.root = (uint32_t)display_list;
+    frame.block_count = block_count;
+    frame.data_size = 0;
+    for (uint32_t i = 0; i < block_count; i++)
+        frame.data_size += (blocks[block_index[i]].size + 3) & ~3;
+
+    FILE *fp = fopen("sm64_trace.bin", "ab");
+    if (fp == NULL)
+        return;
+
+    fwrite(&frame, sizeof(frame), 1, fp);
+    for (uint32_t i = 0; i < block_count; i++)
+        fwrite(&blocks[block_index[i]], sizeof(struct TraceBlock), 1, fp);
+
+    for (uint32_t i = 0; i < block_count; i++) {
+        const struct TraceBlock *block = &blocks[block_index[i]];
+        const uint32_t padding = 0;
+        fwrite((const void*)block->address, 1, block->size, fp);
+        fwrite(&padding, 1, ((block->size + 3) & ~3) - block->size, fp);
+    }
+
+    fclose(fp);
+}
+
+void trace_frame(Gfx *display_list) {
+    // Restart the capture timing whenever the level or area changes
+    if (gCurrLevelNum != last_level || gCurrAreaIndex != last_area) {
+        last_level = gCurrLevelNum;
+        last_area = gCurrAreaIndex;
+        frames_in_area = 0;
+    }
+
+    if (frames_in_area >= SETTLE_FRAMES && (frames_in_area - SETTLE_FRAMES) % CAPTURE_INTERVAL == 0)
+        capture(display_list);
+    frames_in_area++;
+}
+
+#endif // TRACE_CAPTURE
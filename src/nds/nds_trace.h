@@ -0,0 +1,37 @@
+#ifndef NDS_TRACE_H
+#define NDS_TRACE_H
+
+#include <stdint.h>
+
+// Captured frames are appended to a file on SD, each one holding every display list the frame executed and a copy
+// of every block of memory they reference, so the renderer can be run on them again somewhere else
+// Pointers in the copied display lists are left as they were, and are matched with the blocks by address on replay
+#define TRACE_MAGIC 0x30525447 // "GTR0"
+
+enum TraceBlockType {
+    TRACE_DL,  // Display list, up to its G_ENDDL or branch without return
+    TRACE_VTX, // Vertices loaded by G_VTX
+    TRACE_MTX, // Matrix loaded by G_MTX
+    TRACE_MEM, // Viewport or light loaded by G_MOVEMEM
+    TRACE_TEX, // Texture header; texel data isn't kept, since the renderer only reads it to copy it into VRAM
+    TRACE_TYPE_COUNT
+};
+
+struct TraceFrame {
+    uint32_t magic;
+    int16_t level;
+    int16_t area;
+    uint32_t root;        // Address of the frame's display list, which is also the start of the display list pool
+    uint32_t block_count; // Number of blocks in the table that follows
+    uint32_t data_size;   // Size of the block data that follows the table, with each block padded to 4 bytes
+};
+
+struct TraceBlock {
+    uint32_t address;
+    uint32_t size;
+    uint32_t type;
+};
+
+extern void trace_frame(Gfx *display_list);
+
+#endif // NDS_TRACE_H
@@ -1,7 +1,11 @@
 #include <stdio.h>
 #include <string.h>
+
+#include "nds_include.h"
+
 #include "lib/src/libultra_internal.h"
 #include "macros.h"
+#include "nds_profiler.h"
 
 #ifdef TARGET_WEB
 #include <emscripten.h>
@@ -9,7 +13,8 @@
 
 extern OSMgrArgs piMgrArgs;
 
-u64 osClockRate = 62500000;
+// The OS time counts at the DS bus clock, since it comes from hardware timers running at that rate
+u64 osClockRate = 33513982;
 
 s32 osPiStartDma(UNUSED OSIoMesg *mb, UNUSED s32 priority, UNUSED s32 direction,
                  uintptr_t devAddr, void *vAddr, size_t nbytes,
@@ -75,21 +80,22 @@ void osViSwapBuffer(UNUSED void *vaddr) {
 }
 
 OSTime osGetTime(void) {
-    return 0;
+    return profiler_timer_read();
 }
 
 void osWritebackDCacheAll(void) {
 }
 
-void osWritebackDCache(UNUSED void *a, UNUSED size_t b) {
+void osWritebackDCache(void *a, size_t b) {
+    // Data patched in place, like sound banks, has to reach main RAM before the ARM7 reads it
+    DC_FlushRange(a, b);
 }
 
 void osInvalDCache(UNUSED void *a, UNUSED size_t b) {
 }
 
 u32 osGetCount(void) {
-    static u32 counter;
-    return counter++;
+    return (u32) profiler_timer_read();
 }
 
 s32 osAiSetFrequency(u32 freq) {
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Compresses a file in the LZ77 format decoded by the DS BIOS (swiDecompressLZSSWram)
+// Header: 0x10 | (uncompressed size << 8), then groups of 8 blocks, each led by a flag byte (MSB first)
+// A set flag means a 2-byte reference: length - 3 in the top 4 bits, then a 12-bit distance - 1
+
+#define WINDOW_SIZE 0x1000
+#define MIN_MATCH 3
+#define MAX_MATCH 18
+#define HASH_SIZE 0x4000
+#define MAX_CHAIN 512
+
+static int32_t head[HASH_SIZE];
+static int32_t *prev;
+
+static uint32_t hash(const uint8_t *data) {
+    return ((data[0] << 8) ^ (data[1] << 4) ^ data[2]) & (HASH_SIZE - 1);
+}
+
+static void insert(const uint8_t *data, uint32_t pos, uint32_t size) {
+    // Add a position to the chain of earlier positions that start with the same 3 bytes
+    if (pos + MIN_MATCH > size)
+        return;
+    const uint32_t h = hash(&data[pos]);
+    prev[pos] = head[h];
+    head[h] = pos;
+}
+
+static uint32_t find_match(const uint8_t *data, uint32_t pos, uint32_t size, uint32_t *distance) {
+    // Find the longest earlier match within the window, preferring the closest one
+    uint32_t best = 0;
+    if (pos + MIN_MATCH > size)
+        return 0;
+
+    const uint32_t limit = (size - pos < MAX_MATCH) ? size - pos : MAX_MATCH;
+    int32_t cand = head[hash(&data[pos])];
+    for (int chain = 0; cand >= 0 && pos - cand <= WINDOW_SIZE && chain < MAX_CHAIN; chain++, cand = prev[cand]) {
+        uint32_t len = 0;
+        while (len < limit && data[cand + len] == data[pos + len])
+            len++;
+        if (len > best) {
+            best = len;
+            *distance = pos - cand;
+            if (len == limit)
+                break;
+        }
+    }
+    return best >= MIN_MATCH ? best : 0;
+}
+
+static uint8_t *compress(const uint8_t *data, uint32_t size, uint32_t *outSize) {
+    // The worst case is a flag byte for every 8 literals, plus the header and padding
+    uint8_t *out = malloc(4 + size + (size + 7) / 8 + 3);
+    prev = malloc((size ? size : 1) * sizeof(int32_t));
+    if (out == NULL || prev == NULL)
+        return NULL;
+    memset(head, 0xFF, sizeof(head));
+
+    out[0] = 0x10;
+    out[1] = size >> 0;
+    out[2] = size >> 8;
+    out[3] = size >> 16;
+    uint32_t o = 4;
+    uint32_t pos = 0;
+
+    while (pos < size) {
+        const uint32_t flagPos = o++;
+        out[flagPos] = 0;
+
+        for (int i = 0; i < 8 && pos < size; i++) {
+            uint32_t distance = 0;
+            const uint32_t len = find_match(data, pos, size, &distance);
+
+            if (len) {
+                out[flagPos] |= 0x80 >> i;
+                out[o++] = ((len - MIN_MATCH) << 4) | ((distance - 1) >> 8);
+                out[o++] = (distance - 1) & 0xFF;
+                for (uint32_t j = 0; j < len; j++)
+                    insert(data, pos++, size);
+            } else {
+                out[o++] = data[pos];
+                insert(data, pos++, size);
+            }
+        }
+    }
+
+    // Pad to a word, since the files are read straight into aligned buffers
+    while (o & 3)
+        out[o++] = 0;
+
+    free(prev);
+    *outSize = o;
+    return out;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s INPUT OUTPUT\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        fprintf(stderr, "err: Could not open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fseek(in, 0, SEEK_END);
+    const long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if (size >= (1 << 24)) {
+        fprintf(stderr, "err: %s is too large for the LZ77 header\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *data = malloc(size ? size : 1);
+    if (data == NULL || fread(data, 1, size, in) != (size_t) size) {
+        fprintf(stderr, "err: Could not read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    fclose(in);
+
+    uint32_t outSize;
+    uint8_t *out = compress(data, size, &outSize);
+    if (out == NULL) {
+        fprintf(stderr, "err: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[2], "wb");
+    if (file == NULL || fwrite(out, 1, outSize, file) != outSize) {
+        fprintf(stderr, "err: Could not write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    free(out);
+    free(data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Reports how much of the DS binary each level, actor group, and texture bin takes, and what is streamed from
+# NitroFS instead along with the RAM that saves, to show which segments are worth moving out of RAM next
+import os
+import subprocess
+import sys
+
+
+def segment_name(path, build_dir):
+    # Objects are grouped the way the N64 segments were: by level folder, actor group, or texture bin
+    parts = os.path.relpath(path, build_dir).split(os.sep)
+    name = os.path.splitext(parts[-1])[0]
+    if parts[0] == "levels":
+        return "level " + (parts[1] if len(parts) > 2 else name)
+    if parts[0] == "actors":
+        return "actors " + (name[:-4] if name.endswith("_geo") else name)
+    if parts[0] == "bin":
+        return "bin " + name
+    return None
+
+
+def object_sizes(size_tool, paths):
+    # Berkeley totals only count allocated sections, so LTO bytecode in fat objects is left out
+    sizes = {}
+    output = subprocess.check_output([size_tool] + paths, universal_newlines=True)
+    for line in output.splitlines()[1:]:
+        fields = line.split()
+        if len(fields) >= 6:
+            sizes[fields[5]] = int(fields[3])
+    return sizes
+
+
+def main():
+    if len(sys.argv) < 4:
+        print("Usage: {} <size> <elf> <build dir> [objects and streamed .lz files...]".format(sys.argv[0]))
+        sys.exit(1)
+
+    size_tool, elf, build_dir = sys.argv[1:4]
+    objects = [p for p in sys.argv[4:] if p.endswith(".o")]
+    streamed = [p for p in sys.argv[4:] if p.endswith(".lz")]
+
+    segments = {}
+    for path, size in object_sizes(size_tool, objects).items():
+        name = segment_name(path, build_dir)
+        if name is not None:
+            segments[name] = segments.get(name, 0) + size
+
+    print("{:<32} {:>10}".format("Linked segment", "Bytes"))
+    for name, size in sorted(segments.items(), key=lambda s: -s[1]):
+        print("{:<32} {:>10}".format(name, size))
+
+    # The LZ77 header holds the decompressed size
+    print()
+    print("{:<32} {:>10} {:>10}".format("Streamed segment", "Bytes", "Compressed"))
+    streamed_total = 0
+    streamed_max = 0
+    for path in sorted(streamed):
+        with open(path, "rb") as f:
+            header = int.from_bytes(f.read(4), "little")
+        streamed_total += header >> 8
+        streamed_max = max(streamed_max, header >> 8)
+        print("{:<32} {:>10} {:>10}".format(os.path.basename(path), header >> 8, os.path.getsize(path)))
+
+    # Only skyboxes are streamed, and one is loaded into the main pool at a time, so the largest one stays resident
+    print()
+    print("Binary: {} bytes, of which {} are linked segments; {} bytes streamed, saving {} bytes of RAM".format(
+        object_sizes(size_tool, [elf])[elf], sum(segments.values()), streamed_total, streamed_total - streamed_max))
+
+
+if __name__ == "__main__":
+    main()
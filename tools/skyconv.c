@@ -15,6 +15,8 @@
 
 #define SKYCONV_ENCODING ENCODING_U8
 
+#define SCALE_8_5(VAL_) ((((VAL_) + 4) * 0x1F) / 0xFF)
+
 typedef struct {
     rgba *px;
     bool useless;
@@ -296,6 +298,320 @@ static void print_raw_data(FILE *cFile, TextureTile *tile) {
     free(raw);
 }
 
+// NDS skyboxes are drawn on a 2D background layer instead of with textured quads
+// The image is stretched to 256x256 so it wraps around the layer, and stored as 8x8 tiles of 8-bit palette indices
+// Layout: "NBG0", tile count (u16), padding (u16), palette (256 x u16), map (32 x 32 x u16), tiles (count x 64 bytes)
+#define NDS_BG_MAGIC "NBG0"
+#define NDS_BG_SIZE 256
+#define NDS_BG_MAP_SIZE (NDS_BG_SIZE / 8)
+#define NDS_BG_TILES (NDS_BG_MAP_SIZE * NDS_BG_MAP_SIZE)
+#define NDS_BG_MAX_TILES 480 // What fits in the 32KB of BG VRAM beside the map
+#define NDS_BG_COLORS 255    // Index 0 is transparent
+
+typedef struct {
+    uint8_t px[64];
+    uint8_t rgb[64][3];
+    int refs;
+    int nearest;
+    uint32_t nearestDist;
+    bool alive;
+} BgTile;
+
+typedef struct {
+    uint8_t c[3];
+    int count;
+} BgColor;
+
+static int sortAxis;
+
+static int compare_colors(const void *a, const void *b) {
+    return ((const BgColor*)a)->c[sortAxis] - ((const BgColor*)b)->c[sortAxis];
+}
+
+static int quantize_colors(BgColor *colors, int numColors, uint8_t palette[][3]) {
+    // Median cut: keep splitting the box with the widest channel range at the pixel median of that channel
+    int starts[NDS_BG_COLORS + 1] = { 0 };
+    int numBoxes = 1;
+    starts[1] = numColors;
+
+    while (numBoxes < NDS_BG_COLORS) {
+        int best = -1, bestAxis = 0, bestRange = 0;
+        for (int i = 0; i < numBoxes; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                int lo = 0xFF, hi = 0;
+                for (int j = starts[i]; j < starts[i + 1]; j++) {
+                    if (colors[j].c[axis] < lo) lo = colors[j].c[axis];
+                    if (colors[j].c[axis] > hi) hi = colors[j].c[axis];
+                }
+                if (hi - lo > bestRange) {
+                    best = i;
+                    bestAxis = axis;
+                    bestRange = hi - lo;
+                }
+            }
+        }
+        if (best < 0) {
+            break; // Every box is down to one color
+        }
+
+        sortAxis = bestAxis;
+        qsort(&colors[starts[best]], starts[best + 1] - starts[best], sizeof(BgColor), compare_colors);
+
+        int total = 0, half = 0, split = starts[best] + 1;
+        for (int j = starts[best]; j < starts[best + 1]; j++) {
+            total += colors[j].count;
+        }
+        for (int j = starts[best]; j < starts[best + 1] - 1; j++) {
+            half += colors[j].count;
+            split = j + 1;
+            if (half * 2 >= total && colors[j].c[bestAxis] != colors[j + 1].c[bestAxis]) {
+                break;
+            }
+        }
+
+        memmove(&starts[best + 2], &starts[best + 1], (numBoxes - best) * sizeof(int));
+        starts[best + 1] = split;
+        numBoxes++;
+    }
+
+    for (int i = 0; i < numBoxes; i++) {
+        int sum[3] = { 0 }, count = 0;
+        for (int j = starts[i]; j < starts[i + 1]; j++) {
+            for (int axis = 0; axis < 3; axis++) {
+                sum[axis] += colors[j].c[axis] * colors[j].count;
+            }
+            count += colors[j].count;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            palette[i][axis] = (sum[axis] + count / 2) / count;
+        }
+    }
+    return numBoxes;
+}
+
+static int nearest_color(const uint8_t *c, uint8_t palette[][3], int numPalette) {
+    int best = 0;
+    int bestDist = INT_MAX;
+    for (int i = 0; i < numPalette; i++) {
+        int dr = c[0] - palette[i][0], dg = c[1] - palette[i][1], db = c[2] - palette[i][2];
+        int dist = dr * dr + dg * dg + db * db;
+        if (dist < bestDist) {
+            best = i;
+            bestDist = dist;
+        }
+    }
+    return best;
+}
+
+static uint32_t tile_distance(const BgTile *a, const BgTile *b) {
+    uint32_t dist = 0;
+    for (int i = 0; i < 64; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            int d = a->rgb[i][axis] - b->rgb[i][axis];
+            dist += d * d;
+        }
+    }
+    return dist;
+}
+
+static void find_nearest_tile(BgTile *bgTiles, int i) {
+    bgTiles[i].nearest = -1;
+    bgTiles[i].nearestDist = UINT32_MAX;
+    for (int j = 0; j < NDS_BG_TILES; j++) {
+        if (j != i && bgTiles[j].alive) {
+            uint32_t dist = tile_distance(&bgTiles[i], &bgTiles[j]);
+            if (dist < bgTiles[i].nearestDist) {
+                bgTiles[i].nearest = j;
+                bgTiles[i].nearestDist = dist;
+            }
+        }
+    }
+}
+
+static bool match_tile(const uint8_t *a, const uint8_t *b, int flip) {
+    // Compare tile a against tile b with b flipped horizontally (bit 0) and/or vertically (bit 1)
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            int bx = (flip & 1) ? 7 - x : x;
+            int by = (flip & 2) ? 7 - y : y;
+            if (a[y * 8 + x] != b[by * 8 + bx]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void write_skybox_bg(FILE *binFile) {
+    const ImageProps props = IMAGE_PROPERTIES[type][false];
+    const int tileSize = props.tileWidth;
+    const int expandedWidth = IMAGE_PROPERTIES[type][true].tileWidth;
+
+    // Take the skybox without its duplicated edges from the tiles, stretched to the size of the layer
+    static uint8_t image[NDS_BG_SIZE * NDS_BG_SIZE][3];
+    for (int y = 0; y < NDS_BG_SIZE; y++) {
+        for (int x = 0; x < NDS_BG_SIZE; x++) {
+            int sy = (y * 2 + 1) * props.imageHeight / (NDS_BG_SIZE * 2);
+            int sx = (x * 2 + 1) * props.imageWidth / (NDS_BG_SIZE * 2);
+            const rgba *px = &tiles[(sy / tileSize) * props.numCols + sx / tileSize].px[(sy % tileSize) * expandedWidth + sx % tileSize];
+            image[y * NDS_BG_SIZE + x][0] = SCALE_8_5(px->red);
+            image[y * NDS_BG_SIZE + x][1] = SCALE_8_5(px->green);
+            image[y * NDS_BG_SIZE + x][2] = SCALE_8_5(px->blue);
+        }
+    }
+
+    // Build the palette from the colors that are used, counting how often each is
+    static int colorIndex[0x8000];
+    static BgColor colors[0x8000];
+    int numColors = 0;
+    memset(colorIndex, -1, sizeof(colorIndex));
+    for (int i = 0; i < NDS_BG_SIZE * NDS_BG_SIZE; i++) {
+        int key = (image[i][2] << 10) | (image[i][1] << 5) | image[i][0];
+        if (colorIndex[key] < 0) {
+            colorIndex[key] = numColors;
+            memcpy(colors[numColors].c, image[i], 3);
+            colors[numColors++].count = 0;
+        }
+        colors[colorIndex[key]].count++;
+    }
+
+    uint8_t palette[NDS_BG_COLORS][3];
+    int numPalette = quantize_colors(colors, numColors, palette);
+    memset(colorIndex, -1, sizeof(colorIndex));
+
+    // Split the image into tiles, reusing earlier ones that match with or without flipping
+    static BgTile bgTiles[NDS_BG_TILES];
+    uint16_t map[NDS_BG_TILES];
+    int numTiles = 0;
+    for (int t = 0; t < NDS_BG_TILES; t++) {
+        BgTile *tile = &bgTiles[t];
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                const uint8_t *c = image[((t / NDS_BG_MAP_SIZE) * 8 + y) * NDS_BG_SIZE + (t % NDS_BG_MAP_SIZE) * 8 + x];
+                int key = (c[2] << 10) | (c[1] << 5) | c[0];
+                if (colorIndex[key] < 0) {
+                    colorIndex[key] = nearest_color(c, palette, numPalette);
+                }
+                tile->px[y * 8 + x] = colorIndex[key];
+                memcpy(tile->rgb[y * 8 + x], palette[colorIndex[key]], 3);
+            }
+        }
+
+        map[t] = t;
+        tile->alive = true;
+        tile->refs = 1;
+        for (int u = 0; u < t; u++) {
+            if (!bgTiles[u].alive) {
+                continue;
+            }
+            for (int flip = 0; flip < 4; flip++) {
+                if (match_tile(bgTiles[u].px, tile->px, flip)) {
+                    map[t] = u | (flip << 10);
+                    tile->alive = false;
+                    bgTiles[u].refs++;
+                    break;
+                }
+            }
+            if (!tile->alive) {
+                break;
+            }
+        }
+        if (tile->alive) {
+            numTiles++;
+        }
+    }
+
+    // If there are still too many tiles, merge the two most alike until they fit
+    if (numTiles > NDS_BG_MAX_TILES) {
+        INFO("Merging %d skybox tiles down to %d\n", numTiles, NDS_BG_MAX_TILES);
+        for (int i = 0; i < NDS_BG_TILES; i++) {
+            if (bgTiles[i].alive) {
+                find_nearest_tile(bgTiles, i);
+            }
+        }
+    }
+    while (numTiles > NDS_BG_MAX_TILES) {
+        int a = -1;
+        for (int i = 0; i < NDS_BG_TILES; i++) {
+            if (bgTiles[i].alive && (a < 0 || bgTiles[i].nearestDist < bgTiles[a].nearestDist)) {
+                a = i;
+            }
+        }
+        int b = bgTiles[a].nearest;
+        BgTile *keep = &bgTiles[a], *drop = &bgTiles[b];
+
+        // The merged tile is the average of both, weighted by how often each is used
+        for (int i = 0; i < 64; i++) {
+            uint8_t c[3];
+            for (int axis = 0; axis < 3; axis++) {
+                c[axis] = (keep->rgb[i][axis] * keep->refs + drop->rgb[i][axis] * drop->refs + (keep->refs + drop->refs) / 2) /
+                          (keep->refs + drop->refs);
+            }
+            keep->px[i] = nearest_color(c, palette, numPalette);
+            memcpy(keep->rgb[i], palette[keep->px[i]], 3);
+        }
+        keep->refs += drop->refs;
+        drop->alive = false;
+        numTiles--;
+
+        for (int t = 0; t < NDS_BG_TILES; t++) {
+            if ((map[t] & 0x3FF) == b) {
+                map[t] = (map[t] & ~0x3FF) | a;
+            }
+        }
+
+        // Only tiles that were nearest to one of the pair need a full search again
+        find_nearest_tile(bgTiles, a);
+        for (int i = 0; i < NDS_BG_TILES; i++) {
+            if (!bgTiles[i].alive || i == a) {
+                continue;
+            }
+            if (bgTiles[i].nearest == a || bgTiles[i].nearest == b) {
+                find_nearest_tile(bgTiles, i);
+            } else {
+                uint32_t dist = tile_distance(&bgTiles[i], keep);
+                if (dist < bgTiles[i].nearestDist) {
+                    bgTiles[i].nearest = a;
+                    bgTiles[i].nearestDist = dist;
+                }
+            }
+        }
+    }
+
+    // Number the remaining tiles in order and write everything out
+    int newIndex[NDS_BG_TILES];
+    int size = 8 + 256 * 2 + NDS_BG_TILES * 2 + numTiles * 64;
+    uint8_t *raw = calloc(1, size);
+    uint8_t *out = raw + 8 + 256 * 2 + NDS_BG_TILES * 2;
+    numTiles = 0;
+    for (int t = 0; t < NDS_BG_TILES; t++) {
+        if (bgTiles[t].alive) {
+            newIndex[t] = numTiles++;
+            for (int i = 0; i < 64; i++) {
+                *out++ = bgTiles[t].px[i] + 1;
+            }
+        }
+    }
+
+    memcpy(raw, NDS_BG_MAGIC, 4);
+    raw[4] = numTiles & 0xFF;
+    raw[5] = numTiles >> 8;
+    for (int i = 0; i < numPalette; i++) {
+        uint16_t color = (palette[i][2] << 10) | (palette[i][1] << 5) | palette[i][0];
+        raw[8 + (i + 1) * 2] = color & 0xFF;
+        raw[8 + (i + 1) * 2 + 1] = color >> 8;
+    }
+    for (int t = 0; t < NDS_BG_TILES; t++) {
+        uint16_t entry = (map[t] & ~0x3FF) | newIndex[map[t] & 0x3FF];
+        raw[8 + 256 * 2 + t * 2] = entry & 0xFF;
+        raw[8 + 256 * 2 + t * 2 + 1] = entry >> 8;
+    }
+
+    INFO("Converted skybox to NDS background: %d colors, %d tiles\n", numPalette, numTiles);
+    fwrite(raw, 1, size, binFile);
+    free(raw);
+}
+
 static void write_skybox_c() { /* write c data to disc */
     const ImageProps props = IMAGE_PROPERTIES[type][true];
 
@@ -307,6 +623,19 @@ static void write_skybox_c() { /* write c data to disc */
         exit(EXIT_FAILURE);
     }
 
+    if (ndsFormat) {
+        // The background is streamed from NitroFS, so it's written as a binary file to be compressed
+        sprintf(fBuffer, "%s/%s_skybox.bin", output, skyboxName);
+        FILE *binFile = fopen(fBuffer, "wb");
+        if (binFile == NULL) {
+            fprintf(stderr, "err: Could not open %s\n", fBuffer);
+            exit(EXIT_FAILURE);
+        }
+        write_skybox_bg(binFile);
+        fclose(binFile);
+        return;
+    }
+
     sprintf(fBuffer, "%s/%s_skybox.c", output, skyboxName);
     cFile = fopen(fBuffer, "w"); /* reset file */
 
@@ -355,6 +355,117 @@ int rgba2nds(uint8_t *raw, const rgba *img, int width, int height, int depth, in
    return size;
 }
 
+// Paletted NDS textures start with this header, so the renderer can tell them apart from direct color ones
+// It holds a versioned magic, the total size in bytes, then the format, size, palette size and flags; the renderer
+// only trusts it if the total size matches the rest, so direct color texels are very unlikely to pass for one
+#define NDS_PAL_HEADER_SIZE 12
+#define NDS_PAL_VERSION '1'
+
+// DS texture formats, matching GL_TEXTURE_TYPE_ENUM in libnds
+enum {
+   NDS_TEX_RGB4   = 2, // 2bpp, 4 color palette
+   NDS_TEX_RGB16  = 3, // 4bpp, 16 color palette
+   NDS_TEX_RGB256 = 4, // 8bpp, 256 color palette
+};
+
+int rgba2nds_pal(uint8_t *raw, const rgba *img, int width, int height, int nds_width, int nds_height, int max_size)
+{
+   uint16_t palette[256];
+   int count = 0;
+   bool transparent = false;
+
+   // Collect the distinct colors after reducing them to the DS's 15-bit color, so the result is lossless
+   // compared to the direct color conversion; transparent texels all share color 0
+   for (int i = 0; i < width * height; i++) {
+      if (!img[i].alpha) {
+         transparent = true;
+      }
+   }
+   if (transparent) {
+      palette[count++] = 0;
+   }
+   for (int i = 0; i < width * height; i++) {
+      if (!img[i].alpha) {
+         continue;
+      }
+      uint16_t color = SCALE_8_5(img[i].red) | (SCALE_8_5(img[i].green) << 5) | (SCALE_8_5(img[i].blue) << 10);
+      int c;
+      for (c = transparent; c < count && palette[c] != color; c++);
+      if (c == count) {
+         if (count == 256) {
+            return 0;
+         }
+         palette[count++] = color;
+      }
+   }
+
+   // Use the smallest format that fits all the colors
+   int type, bits;
+   if (count <= 4) {
+      type = NDS_TEX_RGB4;
+      bits = 2;
+   } else if (count <= 16) {
+      type = NDS_TEX_RGB16;
+      bits = 4;
+   } else {
+      type = NDS_TEX_RGB256;
+      bits = 8;
+   }
+
+   // Keep direct color if the palette and header would take more space, like for small textures with many colors
+   const int texels_size = nds_width * nds_height * bits / 8;
+   const int pal_count = (count + 1) & ~1;
+   const int size = NDS_PAL_HEADER_SIZE + texels_size + pal_count * 2;
+   if (size >= max_size) {
+      return 0;
+   }
+
+   int size_x, size_y;
+   for (size_x = 0; (8 << size_x) < nds_width; size_x++);
+   for (size_y = 0; (8 << size_y) < nds_height; size_y++);
+
+   INFO("Converting RGBA %dx%d to NDS %d color palette\n", width, height, 1 << bits);
+
+   raw[0] = 'N';
+   raw[1] = 'T';
+   raw[2] = 'X';
+   raw[3] = NDS_PAL_VERSION;
+   raw[4] = size & 0xFF;
+   raw[5] = (size >> 8) & 0xFF;
+   raw[6] = (size >> 16) & 0xFF;
+   raw[7] = (size >> 24) & 0xFF;
+   raw[8] = type;
+   raw[9] = size_x | (size_y << 4);
+   raw[10] = count - 1;
+   raw[11] = transparent;
+
+   // Pack the texel indices, with the first texel in the lowest bits of each byte
+   uint8_t *texels = &raw[NDS_PAL_HEADER_SIZE];
+   memset(texels, 0, texels_size);
+   for (int y = 0; y < nds_height; y++) {
+      for (int x = 0; x < nds_width; x++) {
+         int i = (y % height) * width + (x % width);
+         int j = y * nds_width + x;
+         int index = 0;
+         if (img[i].alpha) {
+            uint16_t color = SCALE_8_5(img[i].red) | (SCALE_8_5(img[i].green) << 5) | (SCALE_8_5(img[i].blue) << 10);
+            for (index = transparent; palette[index] != color; index++);
+         }
+         texels[j * bits / 8] |= index << ((j * bits) % 8);
+      }
+   }
+
+   // Append the palette, padded to a whole number of words for DMA
+   uint8_t *pal = &texels[texels_size];
+   for (int c = 0; c < pal_count; c++) {
+      uint16_t color = (c < count) ? palette[c] : 0;
+      pal[c*2]   = color & 0xFF;
+      pal[c*2+1] = color >> 8;
+   }
+
+   return size;
+}
+
 int ia2nds(uint8_t *raw, const ia *img, int width, int height, int depth, int nds_width, int nds_height)
 {
    int size = (nds_width * nds_height * 8 + 7) / 8;
@@ -982,7 +1093,11 @@ int main(int argc, char *argv[])
                if (!raw) {
                   ERROR("Error allocating %u bytes\n", raw_size);
                }
-               length = rgba2nds(raw, imgr, config.width, config.height, config.format.depth, nds_width, nds_height);
+               // Use a palette if the texture has few enough colors and comes out smaller, otherwise use direct color
+               length = rgba2nds_pal(raw, imgr, config.width, config.height, nds_width, nds_height, raw_size);
+               if (length == 0) {
+                  length = rgba2nds(raw, imgr, config.width, config.height, config.format.depth, nds_width, nds_height);
+               }
             } else {
                raw_size = (config.width * config.height * config.format.depth + 7) / 8;
                raw = malloc(raw_size);
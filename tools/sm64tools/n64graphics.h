@@ -61,6 +61,9 @@ int i2raw(uint8_t *raw, const ia *img, int width, int height, int depth);
 // intermediate RGBA -> NDS raw RGBA16/RGBA32
 int rgba2nds(uint8_t *raw, const rgba *img, int width, int height, int depth, int nds_width, int nds_height);
 
+// intermediate RGBA -> NDS paletted with a header, or 0 if it has more than 256 colors or wouldn't fit in max_size
+int rgba2nds_pal(uint8_t *raw, const rgba *img, int width, int height, int nds_width, int nds_height, int max_size);
+
 // intermediate IA -> NDS raw IA1/IA4/IA8/IA16
 int ia2nds(uint8_t *raw, const ia *img, int width, int height, int depth, int nds_width, int nds_height);
 